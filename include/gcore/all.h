@@ -53,6 +53,8 @@ SOFTWARE.
 #include <gcore/tpl.h>
 #include <gcore/hashmap.h>
 #include <gcore/eventqueue.h>
+#include <gcore/timer.h>
+#include <gcore/pipeline.h>
 #include <gcore/perflog.h>
 #include <gcore/functor.h>
 
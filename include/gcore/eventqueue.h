@@ -33,47 +33,109 @@ namespace gcore
 {
   typedef Functor0 Event;
   
+  // Events are pushed from any thread without locking (intrusive MPSC list)
+  // and run by the thread calling poll. By default only the thread that
+  // created the queue polls, pushing from that thread runs the event straight
+  // away. In multi consumer mode, any thread may poll and consumers only
+  // serialize to take their batch of events.
   class GCORE_API EventQueue
   {
   public:
     
+    // Completion of a pushed event. Each waited on event gets its own slot so
+    // that waiters only get woken up by the event they wait for
+    class GCORE_API Handle
+    {
+    public:
+      
+      Handle();
+      Handle(const Handle &rhs);
+      ~Handle();
+      
+      Handle& operator=(const Handle &rhs);
+      
+      // attached to an event
+      bool valid() const;
+      // the event has been run
+      bool done() const;
+      void wait();
+      // returns false on timeout
+      bool wait(unsigned long msec);
+      
+    private:
+      
+      friend class EventQueue;
+      
+      struct Slot;
+      
+      void reset(bool attach);
+      void signal();
+      
+      Slot *mSlot;
+    };
+    
     struct EventInfo
     {
       Event func;
-      bool sync;
-      size_t id;
+      Handle done;
     };
     
-    typedef std::deque<EventInfo> EventInfoList;
-    
   public:
     
-    EventQueue();
+    EventQueue(bool multiConsumer=false);
     virtual ~EventQueue();
     
     bool push(Event evt, bool sync=false);
+    // push an asynchronous event and attach handle to it
+    bool push(Event evt, Handle &handle);
+    // push asynchronous events at once (a single atomic operation), returns
+    // the number of events queued
+    size_t push(const std::vector<Event> &evts);
+    // run up to count pending events, returns the number of events run
     size_t poll(size_t count);
+    // take up to count pending events without running them, the ones waited
+    // on are run (and completed) by the call instead of being returned
+    size_t poll(size_t count, std::vector<Event> &evts);
     void acceptEvents(bool v);
     
+    inline bool multiConsumer() const
+    {
+      return mMultiConsumer;
+    }
+    
   private:
     
+    struct Node
+    {
+      EventInfo info;
+      Atomic<Node*> next;
+    };
+    
     EventQueue(const EventQueue &);
     EventQueue& operator=(const EventQueue &);
     
-    size_t newID();
+    // link an already chained list of nodes
+    void pushNodes(Node *first, Node *last);
+    // next node or 0 if the queue is empty (or a push is in progress)
+    Node* popNode();
+    // pop up to count nodes, locking the consumers in multi consumer mode
+    size_t popNodes(size_t count, std::vector<Node*> &nodes);
+    bool push(Event evt, Handle &handle, bool attach);
+    void run(Node *node);
     
   protected:
     
     ThreadID mOwner;
-    EventInfoList mEvents;
-    bool mAcceptEvents;
-    size_t mDoneID;
-    std::set<size_t> mQueueIDs;
-    size_t mCurID;
+    bool mMultiConsumer;
+    Atomic<bool> mAcceptEvents;
+    
+    // producers end of the list (last pushed node)
+    Atomic<Node*> mHead;
+    // consumer end of the list
+    Node *mTail;
+    Node mStub;
     
-    Mutex mEventsMutex;
-    Mutex mDoneMutex;
-    Condition mDoneCond;
+    Mutex mConsumersMutex;
   };
 }
 
@@ -50,6 +50,13 @@ SOFTWARE.
 //  types, the callback can still be created)
 // A callback object is typicaly: Functor2wR<bool,int,int>()
 // A function with signature: int (*)(double,double) can still fit in the callback
+//
+// Leading arguments values can also be stored in the callback:
+//   - Bind(funcPtr, a1[, a2, ...], cb)
+//   - Bind(object, methodPtr, a1[, a2, ...], cb)
+// cb parameters being the remaining ones (see 'Bound arguments' below)
+// i.e. a function with signature: void (*)(char,int) and Bind(f, 'a', 10, cb)
+//      gives a Functor0
 
 #define METHOD(className,methodName) &className::methodName
 
@@ -62,14 +69,20 @@ class GCORE_API Functor {
     typedef void (Functor::*_Method)();
     typedef void (*Function)();
     
+    // Size of the storage for bound arguments. It lives here rather than in
+    // the bound translators as callbacks are copied as Functor0, Functor1...
+    static const size_t BoundSize = 4 * sizeof(void*);
+    
     inline Functor()
       : callee(0) {
       ptr.func = 0;
+      memset(bound.mem, 0, BoundSize);
     }
 
     inline Functor(const Functor &rhs)
       : callee(rhs.callee) {
       memcpy(ptr.mem, rhs.ptr.mem, sizeof(_Method));
+      memcpy(bound.mem, rhs.bound.mem, BoundSize);
     }
     
     inline Functor(const void *c, const void *f, size_t sz)
@@ -80,12 +93,14 @@ class GCORE_API Functor {
       } else {
         ptr.func = f;
       }
+      memset(bound.mem, 0, BoundSize);
     }
 
     inline Functor& operator=(const Functor &rhs) {
       if (this != &rhs) {
         callee = rhs.callee;
         memcpy(ptr.mem, rhs.ptr.mem, sizeof(_Method));
+        memcpy(bound.mem, rhs.bound.mem, BoundSize);
       }
       return *this;
     }
@@ -107,6 +122,13 @@ class GCORE_API Functor {
       char mem[sizeof(_Method)];  // is that big enought ?
       const void *func;
     } ptr;
+    
+    union {
+      char mem[BoundSize];
+      void *align0;   // make sure bound values are suitably aligned
+      double align1;
+      Int64 align2;
+    } bound;
 };
 
 // Zero parameter callback
@@ -1131,6 +1153,1725 @@ void Bind(const Callee *c, R (Calltype::*m)(P1,P2,P3,P4) const, Functor4wR<CR,CP
 }
 
 
+// Bound arguments
+//
+// Bind(funcPtr, a1[, a2, ...], cb) and Bind(object, methodPtr, a1[, a2, ...], cb)
+// store the leading argument values inside the callback itself, the remaining
+// parameters being the ones of cb. No memory is allocated: the values are
+// copied bitwise into Functor::bound, so they must be plain data (numbers,
+// pointers, small POD structs) and fit in Functor::BoundSize bytes
+// (both checked at compile time, see BitwiseCopyable).
+// Note: argument types are deduced from the values passed to Bind
+//       i.e. Bind(f, 0, cb) stores an int even if f expects a pointer
+
+template <typename A1>
+struct BoundArgs1 {
+  A1 a1;
+};
+
+template <typename A1, typename A2>
+struct BoundArgs2 {
+  A1 a1;
+  A2 a2;
+};
+
+template <typename A1, typename A2, typename A3>
+struct BoundArgs3 {
+  A1 a1;
+  A2 a2;
+  A3 a3;
+};
+
+template <typename A1, typename A2, typename A3, typename A4>
+struct BoundArgs4 {
+  A1 a1;
+  A2 a2;
+  A3 a3;
+  A4 a4;
+};
+
+// Types with trivial copy and destruction. std::string and the likes would be
+// duplicated without their copy constructor and destroyed twice.
+// Compilers without type traits builtins only accept numbers and pointers,
+// specialize it for other plain types.
+#if defined(__GNUC__) || defined(__clang__) || defined(_MSC_VER)
+#  define GCORE_TYPE_TRAITS_BUILTINS
+#endif
+
+template <typename T>
+struct BitwiseCopyable {
+#if defined(__clang__)
+  enum { Value = __is_trivially_copyable(T) };
+#elif defined(GCORE_TYPE_TRAITS_BUILTINS)
+  enum { Value = (__has_trivial_copy(T) && __has_trivial_destructor(T)) };
+#else
+  enum { Value = 0 };
+#endif
+};
+
+template <typename T>
+struct BitwiseCopyable<T*> {
+  enum { Value = 1 };
+};
+
+#ifndef GCORE_TYPE_TRAITS_BUILTINS
+#  define GCORE_BITWISE_COPYABLE(T) template <> struct BitwiseCopyable<T> { enum { Value = 1 }; };
+GCORE_BITWISE_COPYABLE(bool)
+GCORE_BITWISE_COPYABLE(char)
+GCORE_BITWISE_COPYABLE(signed char)
+GCORE_BITWISE_COPYABLE(unsigned char)
+GCORE_BITWISE_COPYABLE(short)
+GCORE_BITWISE_COPYABLE(unsigned short)
+GCORE_BITWISE_COPYABLE(int)
+GCORE_BITWISE_COPYABLE(unsigned int)
+GCORE_BITWISE_COPYABLE(long)
+GCORE_BITWISE_COPYABLE(unsigned long)
+GCORE_BITWISE_COPYABLE(float)
+GCORE_BITWISE_COPYABLE(double)
+#  undef GCORE_BITWISE_COPYABLE
+#endif
+
+template <typename A1>
+struct BitwiseCopyable< BoundArgs1<A1> > {
+  enum { Value = BitwiseCopyable<A1>::Value };
+};
+
+template <typename A1, typename A2>
+struct BitwiseCopyable< BoundArgs2<A1,A2> > {
+  enum { Value = (BitwiseCopyable<A1>::Value && BitwiseCopyable<A2>::Value) };
+};
+
+template <typename A1, typename A2, typename A3>
+struct BitwiseCopyable< BoundArgs3<A1,A2,A3> > {
+  enum { Value = (BitwiseCopyable<A1>::Value && BitwiseCopyable<A2>::Value && BitwiseCopyable<A3>::Value) };
+};
+
+template <typename A1, typename A2, typename A3, typename A4>
+struct BitwiseCopyable< BoundArgs4<A1,A2,A3,A4> > {
+  enum { Value = (BitwiseCopyable<A1>::Value && BitwiseCopyable<A2>::Value &&
+                  BitwiseCopyable<A3>::Value && BitwiseCopyable<A4>::Value) };
+};
+
+template <typename Func, typename A1>
+class BoundFunctionTranslator0_1 : public Functor0 {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator0_1(Func f, A1 a1)
+      : Functor0(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator0_1(const BoundFunctionTranslator0_1<Func,A1> &rhs)
+      : Functor0(rhs) {
+    }
+    
+    BoundFunctionTranslator0_1<Func,A1>& operator=(const BoundFunctionTranslator0_1<Func,A1> &rhs) {
+      Functor0::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1);
+    }
+};
+
+template <class Callee, typename Method, typename A1>
+class BoundMethodTranslator0_1 : public Functor0 {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator0_1(Callee *c, Method &m, A1 a1)
+      : Functor0(call, c, &m, sizeof(Method)) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator0_1(const BoundMethodTranslator0_1<Callee,Method,A1> &rhs)
+      : Functor0(rhs) {
+    }
+    
+    BoundMethodTranslator0_1<Callee,Method,A1>& operator=(const BoundMethodTranslator0_1<Callee,Method,A1> &rhs) {
+      Functor0::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1);
+    }
+};
+
+template <typename R, typename Func, typename A1>
+class BoundFunctionTranslator0wR_1 : public Functor0wR<R> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator0wR_1(Func f, A1 a1)
+      : Functor0wR<R>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator0wR_1(const BoundFunctionTranslator0wR_1<R,Func,A1> &rhs)
+      : Functor0wR<R>(rhs) {
+    }
+    
+    BoundFunctionTranslator0wR_1<R,Func,A1>& operator=(const BoundFunctionTranslator0wR_1<R,Func,A1> &rhs) {
+      Functor0wR<R>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1);
+    }
+};
+
+template <typename R, class Callee, typename Method, typename A1>
+class BoundMethodTranslator0wR_1 : public Functor0wR<R> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator0wR_1(Callee *c, Method &m, A1 a1)
+      : Functor0wR<R>(call, c, &m, sizeof(Method)) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator0wR_1(const BoundMethodTranslator0wR_1<R,Callee,Method,A1> &rhs)
+      : Functor0wR<R>(rhs) {
+    }
+    
+    BoundMethodTranslator0wR_1<R,Callee,Method,A1>& operator=(const BoundMethodTranslator0wR_1<R,Callee,Method,A1> &rhs) {
+      Functor0wR<R>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1);
+    }
+};
+
+template <typename Func, typename A1, typename A2>
+class BoundFunctionTranslator0_2 : public Functor0 {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator0_2(Func f, A1 a1, A2 a2)
+      : Functor0(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator0_2(const BoundFunctionTranslator0_2<Func,A1,A2> &rhs)
+      : Functor0(rhs) {
+    }
+    
+    BoundFunctionTranslator0_2<Func,A1,A2>& operator=(const BoundFunctionTranslator0_2<Func,A1,A2> &rhs) {
+      Functor0::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2);
+    }
+};
+
+template <class Callee, typename Method, typename A1, typename A2>
+class BoundMethodTranslator0_2 : public Functor0 {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator0_2(Callee *c, Method &m, A1 a1, A2 a2)
+      : Functor0(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator0_2(const BoundMethodTranslator0_2<Callee,Method,A1,A2> &rhs)
+      : Functor0(rhs) {
+    }
+    
+    BoundMethodTranslator0_2<Callee,Method,A1,A2>& operator=(const BoundMethodTranslator0_2<Callee,Method,A1,A2> &rhs) {
+      Functor0::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1,args.a2);
+    }
+};
+
+template <typename R, typename Func, typename A1, typename A2>
+class BoundFunctionTranslator0wR_2 : public Functor0wR<R> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator0wR_2(Func f, A1 a1, A2 a2)
+      : Functor0wR<R>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator0wR_2(const BoundFunctionTranslator0wR_2<R,Func,A1,A2> &rhs)
+      : Functor0wR<R>(rhs) {
+    }
+    
+    BoundFunctionTranslator0wR_2<R,Func,A1,A2>& operator=(const BoundFunctionTranslator0wR_2<R,Func,A1,A2> &rhs) {
+      Functor0wR<R>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2);
+    }
+};
+
+template <typename R, class Callee, typename Method, typename A1, typename A2>
+class BoundMethodTranslator0wR_2 : public Functor0wR<R> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator0wR_2(Callee *c, Method &m, A1 a1, A2 a2)
+      : Functor0wR<R>(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator0wR_2(const BoundMethodTranslator0wR_2<R,Callee,Method,A1,A2> &rhs)
+      : Functor0wR<R>(rhs) {
+    }
+    
+    BoundMethodTranslator0wR_2<R,Callee,Method,A1,A2>& operator=(const BoundMethodTranslator0wR_2<R,Callee,Method,A1,A2> &rhs) {
+      Functor0wR<R>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1,args.a2);
+    }
+};
+
+template <typename Func, typename A1, typename A2, typename A3>
+class BoundFunctionTranslator0_3 : public Functor0 {
+  
+  public:
+    
+    typedef BoundArgs3<A1,A2,A3> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator0_3(Func f, A1 a1, A2 a2, A3 a3)
+      : Functor0(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2, a3};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator0_3(const BoundFunctionTranslator0_3<Func,A1,A2,A3> &rhs)
+      : Functor0(rhs) {
+    }
+    
+    BoundFunctionTranslator0_3<Func,A1,A2,A3>& operator=(const BoundFunctionTranslator0_3<Func,A1,A2,A3> &rhs) {
+      Functor0::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,args.a3);
+    }
+};
+
+template <class Callee, typename Method, typename A1, typename A2, typename A3>
+class BoundMethodTranslator0_3 : public Functor0 {
+  
+  public:
+    
+    typedef BoundArgs3<A1,A2,A3> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator0_3(Callee *c, Method &m, A1 a1, A2 a2, A3 a3)
+      : Functor0(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2, a3};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator0_3(const BoundMethodTranslator0_3<Callee,Method,A1,A2,A3> &rhs)
+      : Functor0(rhs) {
+    }
+    
+    BoundMethodTranslator0_3<Callee,Method,A1,A2,A3>& operator=(const BoundMethodTranslator0_3<Callee,Method,A1,A2,A3> &rhs) {
+      Functor0::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1,args.a2,args.a3);
+    }
+};
+
+template <typename R, typename Func, typename A1, typename A2, typename A3>
+class BoundFunctionTranslator0wR_3 : public Functor0wR<R> {
+  
+  public:
+    
+    typedef BoundArgs3<A1,A2,A3> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator0wR_3(Func f, A1 a1, A2 a2, A3 a3)
+      : Functor0wR<R>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2, a3};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator0wR_3(const BoundFunctionTranslator0wR_3<R,Func,A1,A2,A3> &rhs)
+      : Functor0wR<R>(rhs) {
+    }
+    
+    BoundFunctionTranslator0wR_3<R,Func,A1,A2,A3>& operator=(const BoundFunctionTranslator0wR_3<R,Func,A1,A2,A3> &rhs) {
+      Functor0wR<R>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,args.a3);
+    }
+};
+
+template <typename R, class Callee, typename Method, typename A1, typename A2, typename A3>
+class BoundMethodTranslator0wR_3 : public Functor0wR<R> {
+  
+  public:
+    
+    typedef BoundArgs3<A1,A2,A3> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator0wR_3(Callee *c, Method &m, A1 a1, A2 a2, A3 a3)
+      : Functor0wR<R>(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2, a3};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator0wR_3(const BoundMethodTranslator0wR_3<R,Callee,Method,A1,A2,A3> &rhs)
+      : Functor0wR<R>(rhs) {
+    }
+    
+    BoundMethodTranslator0wR_3<R,Callee,Method,A1,A2,A3>& operator=(const BoundMethodTranslator0wR_3<R,Callee,Method,A1,A2,A3> &rhs) {
+      Functor0wR<R>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1,args.a2,args.a3);
+    }
+};
+
+template <typename Func, typename A1, typename A2, typename A3, typename A4>
+class BoundFunctionTranslator0_4 : public Functor0 {
+  
+  public:
+    
+    typedef BoundArgs4<A1,A2,A3,A4> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator0_4(Func f, A1 a1, A2 a2, A3 a3, A4 a4)
+      : Functor0(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2, a3, a4};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator0_4(const BoundFunctionTranslator0_4<Func,A1,A2,A3,A4> &rhs)
+      : Functor0(rhs) {
+    }
+    
+    BoundFunctionTranslator0_4<Func,A1,A2,A3,A4>& operator=(const BoundFunctionTranslator0_4<Func,A1,A2,A3,A4> &rhs) {
+      Functor0::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,args.a3,args.a4);
+    }
+};
+
+template <class Callee, typename Method, typename A1, typename A2, typename A3, typename A4>
+class BoundMethodTranslator0_4 : public Functor0 {
+  
+  public:
+    
+    typedef BoundArgs4<A1,A2,A3,A4> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator0_4(Callee *c, Method &m, A1 a1, A2 a2, A3 a3, A4 a4)
+      : Functor0(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2, a3, a4};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator0_4(const BoundMethodTranslator0_4<Callee,Method,A1,A2,A3,A4> &rhs)
+      : Functor0(rhs) {
+    }
+    
+    BoundMethodTranslator0_4<Callee,Method,A1,A2,A3,A4>& operator=(const BoundMethodTranslator0_4<Callee,Method,A1,A2,A3,A4> &rhs) {
+      Functor0::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1,args.a2,args.a3,args.a4);
+    }
+};
+
+template <typename R, typename Func, typename A1, typename A2, typename A3, typename A4>
+class BoundFunctionTranslator0wR_4 : public Functor0wR<R> {
+  
+  public:
+    
+    typedef BoundArgs4<A1,A2,A3,A4> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator0wR_4(Func f, A1 a1, A2 a2, A3 a3, A4 a4)
+      : Functor0wR<R>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2, a3, a4};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator0wR_4(const BoundFunctionTranslator0wR_4<R,Func,A1,A2,A3,A4> &rhs)
+      : Functor0wR<R>(rhs) {
+    }
+    
+    BoundFunctionTranslator0wR_4<R,Func,A1,A2,A3,A4>& operator=(const BoundFunctionTranslator0wR_4<R,Func,A1,A2,A3,A4> &rhs) {
+      Functor0wR<R>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,args.a3,args.a4);
+    }
+};
+
+template <typename R, class Callee, typename Method, typename A1, typename A2, typename A3, typename A4>
+class BoundMethodTranslator0wR_4 : public Functor0wR<R> {
+  
+  public:
+    
+    typedef BoundArgs4<A1,A2,A3,A4> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator0wR_4(Callee *c, Method &m, A1 a1, A2 a2, A3 a3, A4 a4)
+      : Functor0wR<R>(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2, a3, a4};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator0wR_4(const BoundMethodTranslator0wR_4<R,Callee,Method,A1,A2,A3,A4> &rhs)
+      : Functor0wR<R>(rhs) {
+    }
+    
+    BoundMethodTranslator0wR_4<R,Callee,Method,A1,A2,A3,A4>& operator=(const BoundMethodTranslator0wR_4<R,Callee,Method,A1,A2,A3,A4> &rhs) {
+      Functor0wR<R>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1,args.a2,args.a3,args.a4);
+    }
+};
+
+template <typename P1, typename Func, typename A1>
+class BoundFunctionTranslator1_1 : public Functor1<P1> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator1_1(Func f, A1 a1)
+      : Functor1<P1>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator1_1(const BoundFunctionTranslator1_1<P1,Func,A1> &rhs)
+      : Functor1<P1>(rhs) {
+    }
+    
+    BoundFunctionTranslator1_1<P1,Func,A1>& operator=(const BoundFunctionTranslator1_1<P1,Func,A1> &rhs) {
+      Functor1<P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1,p1);
+    }
+};
+
+template <class Callee, typename P1, typename Method, typename A1>
+class BoundMethodTranslator1_1 : public Functor1<P1> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator1_1(Callee *c, Method &m, A1 a1)
+      : Functor1<P1>(call, c, &m, sizeof(Method)) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator1_1(const BoundMethodTranslator1_1<Callee,P1,Method,A1> &rhs)
+      : Functor1<P1>(rhs) {
+    }
+    
+    BoundMethodTranslator1_1<Callee,P1,Method,A1>& operator=(const BoundMethodTranslator1_1<Callee,P1,Method,A1> &rhs) {
+      Functor1<P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1,p1);
+    }
+};
+
+template <typename R, typename P1, typename Func, typename A1>
+class BoundFunctionTranslator1wR_1 : public Functor1wR<R,P1> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator1wR_1(Func f, A1 a1)
+      : Functor1wR<R,P1>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator1wR_1(const BoundFunctionTranslator1wR_1<R,P1,Func,A1> &rhs)
+      : Functor1wR<R,P1>(rhs) {
+    }
+    
+    BoundFunctionTranslator1wR_1<R,P1,Func,A1>& operator=(const BoundFunctionTranslator1wR_1<R,P1,Func,A1> &rhs) {
+      Functor1wR<R,P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1,p1);
+    }
+};
+
+template <typename R, class Callee, typename P1, typename Method, typename A1>
+class BoundMethodTranslator1wR_1 : public Functor1wR<R,P1> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator1wR_1(Callee *c, Method &m, A1 a1)
+      : Functor1wR<R,P1>(call, c, &m, sizeof(Method)) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator1wR_1(const BoundMethodTranslator1wR_1<R,Callee,P1,Method,A1> &rhs)
+      : Functor1wR<R,P1>(rhs) {
+    }
+    
+    BoundMethodTranslator1wR_1<R,Callee,P1,Method,A1>& operator=(const BoundMethodTranslator1wR_1<R,Callee,P1,Method,A1> &rhs) {
+      Functor1wR<R,P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1,p1);
+    }
+};
+
+template <typename P1, typename Func, typename A1, typename A2>
+class BoundFunctionTranslator1_2 : public Functor1<P1> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator1_2(Func f, A1 a1, A2 a2)
+      : Functor1<P1>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator1_2(const BoundFunctionTranslator1_2<P1,Func,A1,A2> &rhs)
+      : Functor1<P1>(rhs) {
+    }
+    
+    BoundFunctionTranslator1_2<P1,Func,A1,A2>& operator=(const BoundFunctionTranslator1_2<P1,Func,A1,A2> &rhs) {
+      Functor1<P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,p1);
+    }
+};
+
+template <class Callee, typename P1, typename Method, typename A1, typename A2>
+class BoundMethodTranslator1_2 : public Functor1<P1> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator1_2(Callee *c, Method &m, A1 a1, A2 a2)
+      : Functor1<P1>(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator1_2(const BoundMethodTranslator1_2<Callee,P1,Method,A1,A2> &rhs)
+      : Functor1<P1>(rhs) {
+    }
+    
+    BoundMethodTranslator1_2<Callee,P1,Method,A1,A2>& operator=(const BoundMethodTranslator1_2<Callee,P1,Method,A1,A2> &rhs) {
+      Functor1<P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1,args.a2,p1);
+    }
+};
+
+template <typename R, typename P1, typename Func, typename A1, typename A2>
+class BoundFunctionTranslator1wR_2 : public Functor1wR<R,P1> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator1wR_2(Func f, A1 a1, A2 a2)
+      : Functor1wR<R,P1>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator1wR_2(const BoundFunctionTranslator1wR_2<R,P1,Func,A1,A2> &rhs)
+      : Functor1wR<R,P1>(rhs) {
+    }
+    
+    BoundFunctionTranslator1wR_2<R,P1,Func,A1,A2>& operator=(const BoundFunctionTranslator1wR_2<R,P1,Func,A1,A2> &rhs) {
+      Functor1wR<R,P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,p1);
+    }
+};
+
+template <typename R, class Callee, typename P1, typename Method, typename A1, typename A2>
+class BoundMethodTranslator1wR_2 : public Functor1wR<R,P1> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator1wR_2(Callee *c, Method &m, A1 a1, A2 a2)
+      : Functor1wR<R,P1>(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator1wR_2(const BoundMethodTranslator1wR_2<R,Callee,P1,Method,A1,A2> &rhs)
+      : Functor1wR<R,P1>(rhs) {
+    }
+    
+    BoundMethodTranslator1wR_2<R,Callee,P1,Method,A1,A2>& operator=(const BoundMethodTranslator1wR_2<R,Callee,P1,Method,A1,A2> &rhs) {
+      Functor1wR<R,P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1,args.a2,p1);
+    }
+};
+
+template <typename P1, typename Func, typename A1, typename A2, typename A3>
+class BoundFunctionTranslator1_3 : public Functor1<P1> {
+  
+  public:
+    
+    typedef BoundArgs3<A1,A2,A3> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator1_3(Func f, A1 a1, A2 a2, A3 a3)
+      : Functor1<P1>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2, a3};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator1_3(const BoundFunctionTranslator1_3<P1,Func,A1,A2,A3> &rhs)
+      : Functor1<P1>(rhs) {
+    }
+    
+    BoundFunctionTranslator1_3<P1,Func,A1,A2,A3>& operator=(const BoundFunctionTranslator1_3<P1,Func,A1,A2,A3> &rhs) {
+      Functor1<P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,args.a3,p1);
+    }
+};
+
+template <class Callee, typename P1, typename Method, typename A1, typename A2, typename A3>
+class BoundMethodTranslator1_3 : public Functor1<P1> {
+  
+  public:
+    
+    typedef BoundArgs3<A1,A2,A3> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator1_3(Callee *c, Method &m, A1 a1, A2 a2, A3 a3)
+      : Functor1<P1>(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2, a3};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator1_3(const BoundMethodTranslator1_3<Callee,P1,Method,A1,A2,A3> &rhs)
+      : Functor1<P1>(rhs) {
+    }
+    
+    BoundMethodTranslator1_3<Callee,P1,Method,A1,A2,A3>& operator=(const BoundMethodTranslator1_3<Callee,P1,Method,A1,A2,A3> &rhs) {
+      Functor1<P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1,args.a2,args.a3,p1);
+    }
+};
+
+template <typename R, typename P1, typename Func, typename A1, typename A2, typename A3>
+class BoundFunctionTranslator1wR_3 : public Functor1wR<R,P1> {
+  
+  public:
+    
+    typedef BoundArgs3<A1,A2,A3> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator1wR_3(Func f, A1 a1, A2 a2, A3 a3)
+      : Functor1wR<R,P1>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2, a3};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator1wR_3(const BoundFunctionTranslator1wR_3<R,P1,Func,A1,A2,A3> &rhs)
+      : Functor1wR<R,P1>(rhs) {
+    }
+    
+    BoundFunctionTranslator1wR_3<R,P1,Func,A1,A2,A3>& operator=(const BoundFunctionTranslator1wR_3<R,P1,Func,A1,A2,A3> &rhs) {
+      Functor1wR<R,P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,args.a3,p1);
+    }
+};
+
+template <typename R, class Callee, typename P1, typename Method, typename A1, typename A2, typename A3>
+class BoundMethodTranslator1wR_3 : public Functor1wR<R,P1> {
+  
+  public:
+    
+    typedef BoundArgs3<A1,A2,A3> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator1wR_3(Callee *c, Method &m, A1 a1, A2 a2, A3 a3)
+      : Functor1wR<R,P1>(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2, a3};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator1wR_3(const BoundMethodTranslator1wR_3<R,Callee,P1,Method,A1,A2,A3> &rhs)
+      : Functor1wR<R,P1>(rhs) {
+    }
+    
+    BoundMethodTranslator1wR_3<R,Callee,P1,Method,A1,A2,A3>& operator=(const BoundMethodTranslator1wR_3<R,Callee,P1,Method,A1,A2,A3> &rhs) {
+      Functor1wR<R,P1>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1,args.a2,args.a3,p1);
+    }
+};
+
+template <typename P1, typename P2, typename Func, typename A1>
+class BoundFunctionTranslator2_1 : public Functor2<P1,P2> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator2_1(Func f, A1 a1)
+      : Functor2<P1,P2>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator2_1(const BoundFunctionTranslator2_1<P1,P2,Func,A1> &rhs)
+      : Functor2<P1,P2>(rhs) {
+    }
+    
+    BoundFunctionTranslator2_1<P1,P2,Func,A1>& operator=(const BoundFunctionTranslator2_1<P1,P2,Func,A1> &rhs) {
+      Functor2<P1,P2>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1, P2 p2) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1,p1,p2);
+    }
+};
+
+template <class Callee, typename P1, typename P2, typename Method, typename A1>
+class BoundMethodTranslator2_1 : public Functor2<P1,P2> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator2_1(Callee *c, Method &m, A1 a1)
+      : Functor2<P1,P2>(call, c, &m, sizeof(Method)) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator2_1(const BoundMethodTranslator2_1<Callee,P1,P2,Method,A1> &rhs)
+      : Functor2<P1,P2>(rhs) {
+    }
+    
+    BoundMethodTranslator2_1<Callee,P1,P2,Method,A1>& operator=(const BoundMethodTranslator2_1<Callee,P1,P2,Method,A1> &rhs) {
+      Functor2<P1,P2>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1, P2 p2) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1,p1,p2);
+    }
+};
+
+template <typename R, typename P1, typename P2, typename Func, typename A1>
+class BoundFunctionTranslator2wR_1 : public Functor2wR<R,P1,P2> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator2wR_1(Func f, A1 a1)
+      : Functor2wR<R,P1,P2>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator2wR_1(const BoundFunctionTranslator2wR_1<R,P1,P2,Func,A1> &rhs)
+      : Functor2wR<R,P1,P2>(rhs) {
+    }
+    
+    BoundFunctionTranslator2wR_1<R,P1,P2,Func,A1>& operator=(const BoundFunctionTranslator2wR_1<R,P1,P2,Func,A1> &rhs) {
+      Functor2wR<R,P1,P2>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1, P2 p2) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1,p1,p2);
+    }
+};
+
+template <typename R, class Callee, typename P1, typename P2, typename Method, typename A1>
+class BoundMethodTranslator2wR_1 : public Functor2wR<R,P1,P2> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator2wR_1(Callee *c, Method &m, A1 a1)
+      : Functor2wR<R,P1,P2>(call, c, &m, sizeof(Method)) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator2wR_1(const BoundMethodTranslator2wR_1<R,Callee,P1,P2,Method,A1> &rhs)
+      : Functor2wR<R,P1,P2>(rhs) {
+    }
+    
+    BoundMethodTranslator2wR_1<R,Callee,P1,P2,Method,A1>& operator=(const BoundMethodTranslator2wR_1<R,Callee,P1,P2,Method,A1> &rhs) {
+      Functor2wR<R,P1,P2>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1, P2 p2) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1,p1,p2);
+    }
+};
+
+template <typename P1, typename P2, typename Func, typename A1, typename A2>
+class BoundFunctionTranslator2_2 : public Functor2<P1,P2> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator2_2(Func f, A1 a1, A2 a2)
+      : Functor2<P1,P2>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator2_2(const BoundFunctionTranslator2_2<P1,P2,Func,A1,A2> &rhs)
+      : Functor2<P1,P2>(rhs) {
+    }
+    
+    BoundFunctionTranslator2_2<P1,P2,Func,A1,A2>& operator=(const BoundFunctionTranslator2_2<P1,P2,Func,A1,A2> &rhs) {
+      Functor2<P1,P2>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1, P2 p2) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,p1,p2);
+    }
+};
+
+template <class Callee, typename P1, typename P2, typename Method, typename A1, typename A2>
+class BoundMethodTranslator2_2 : public Functor2<P1,P2> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator2_2(Callee *c, Method &m, A1 a1, A2 a2)
+      : Functor2<P1,P2>(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator2_2(const BoundMethodTranslator2_2<Callee,P1,P2,Method,A1,A2> &rhs)
+      : Functor2<P1,P2>(rhs) {
+    }
+    
+    BoundMethodTranslator2_2<Callee,P1,P2,Method,A1,A2>& operator=(const BoundMethodTranslator2_2<Callee,P1,P2,Method,A1,A2> &rhs) {
+      Functor2<P1,P2>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1, P2 p2) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1,args.a2,p1,p2);
+    }
+};
+
+template <typename R, typename P1, typename P2, typename Func, typename A1, typename A2>
+class BoundFunctionTranslator2wR_2 : public Functor2wR<R,P1,P2> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator2wR_2(Func f, A1 a1, A2 a2)
+      : Functor2wR<R,P1,P2>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator2wR_2(const BoundFunctionTranslator2wR_2<R,P1,P2,Func,A1,A2> &rhs)
+      : Functor2wR<R,P1,P2>(rhs) {
+    }
+    
+    BoundFunctionTranslator2wR_2<R,P1,P2,Func,A1,A2>& operator=(const BoundFunctionTranslator2wR_2<R,P1,P2,Func,A1,A2> &rhs) {
+      Functor2wR<R,P1,P2>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1, P2 p2) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1,args.a2,p1,p2);
+    }
+};
+
+template <typename R, class Callee, typename P1, typename P2, typename Method, typename A1, typename A2>
+class BoundMethodTranslator2wR_2 : public Functor2wR<R,P1,P2> {
+  
+  public:
+    
+    typedef BoundArgs2<A1,A2> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator2wR_2(Callee *c, Method &m, A1 a1, A2 a2)
+      : Functor2wR<R,P1,P2>(call, c, &m, sizeof(Method)) {
+      Args args = {a1, a2};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator2wR_2(const BoundMethodTranslator2wR_2<R,Callee,P1,P2,Method,A1,A2> &rhs)
+      : Functor2wR<R,P1,P2>(rhs) {
+    }
+    
+    BoundMethodTranslator2wR_2<R,Callee,P1,P2,Method,A1,A2>& operator=(const BoundMethodTranslator2wR_2<R,Callee,P1,P2,Method,A1,A2> &rhs) {
+      Functor2wR<R,P1,P2>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1, P2 p2) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1,args.a2,p1,p2);
+    }
+};
+
+template <typename P1, typename P2, typename P3, typename Func, typename A1>
+class BoundFunctionTranslator3_1 : public Functor3<P1,P2,P3> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator3_1(Func f, A1 a1)
+      : Functor3<P1,P2,P3>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator3_1(const BoundFunctionTranslator3_1<P1,P2,P3,Func,A1> &rhs)
+      : Functor3<P1,P2,P3>(rhs) {
+    }
+    
+    BoundFunctionTranslator3_1<P1,P2,P3,Func,A1>& operator=(const BoundFunctionTranslator3_1<P1,P2,P3,Func,A1> &rhs) {
+      Functor3<P1,P2,P3>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1, P2 p2, P3 p3) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      FPTR_CAST(Func, cb.ptr.func)(args.a1,p1,p2,p3);
+    }
+};
+
+template <class Callee, typename P1, typename P2, typename P3, typename Method, typename A1>
+class BoundMethodTranslator3_1 : public Functor3<P1,P2,P3> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator3_1(Callee *c, Method &m, A1 a1)
+      : Functor3<P1,P2,P3>(call, c, &m, sizeof(Method)) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator3_1(const BoundMethodTranslator3_1<Callee,P1,P2,P3,Method,A1> &rhs)
+      : Functor3<P1,P2,P3>(rhs) {
+    }
+    
+    BoundMethodTranslator3_1<Callee,P1,P2,P3,Method,A1>& operator=(const BoundMethodTranslator3_1<Callee,P1,P2,P3,Method,A1> &rhs) {
+      Functor3<P1,P2,P3>::operator=(rhs);
+      return *this;
+    }
+    
+    static void call(const Functor &cb, P1 p1, P2 p2, P3 p3) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      (callee->*method)(args.a1,p1,p2,p3);
+    }
+};
+
+template <typename R, typename P1, typename P2, typename P3, typename Func, typename A1>
+class BoundFunctionTranslator3wR_1 : public Functor3wR<R,P1,P2,P3> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundFunctionTranslator3wR_1(Func f, A1 a1)
+      : Functor3wR<R,P1,P2,P3>(call, 0, FPTR_CAST(const void*, f), 0) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundFunctionTranslator3wR_1(const BoundFunctionTranslator3wR_1<R,P1,P2,P3,Func,A1> &rhs)
+      : Functor3wR<R,P1,P2,P3>(rhs) {
+    }
+    
+    BoundFunctionTranslator3wR_1<R,P1,P2,P3,Func,A1>& operator=(const BoundFunctionTranslator3wR_1<R,P1,P2,P3,Func,A1> &rhs) {
+      Functor3wR<R,P1,P2,P3>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1, P2 p2, P3 p3) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      return FPTR_CAST(Func, cb.ptr.func)(args.a1,p1,p2,p3);
+    }
+};
+
+template <typename R, class Callee, typename P1, typename P2, typename P3, typename Method, typename A1>
+class BoundMethodTranslator3wR_1 : public Functor3wR<R,P1,P2,P3> {
+  
+  public:
+    
+    typedef BoundArgs1<A1> Args;
+    typedef char ArgsSizeCheck[sizeof(Args) <= Functor::BoundSize ? 1 : -1];
+    typedef char ArgsCopyCheck[BitwiseCopyable<Args>::Value ? 1 : -1];
+    
+    BoundMethodTranslator3wR_1(Callee *c, Method &m, A1 a1)
+      : Functor3wR<R,P1,P2,P3>(call, c, &m, sizeof(Method)) {
+      Args args = {a1};
+      memcpy(this->bound.mem, &args, sizeof(Args));
+    }
+    
+    BoundMethodTranslator3wR_1(const BoundMethodTranslator3wR_1<R,Callee,P1,P2,P3,Method,A1> &rhs)
+      : Functor3wR<R,P1,P2,P3>(rhs) {
+    }
+    
+    BoundMethodTranslator3wR_1<R,Callee,P1,P2,P3,Method,A1>& operator=(const BoundMethodTranslator3wR_1<R,Callee,P1,P2,P3,Method,A1> &rhs) {
+      Functor3wR<R,P1,P2,P3>::operator=(rhs);
+      return *this;
+    }
+    
+    static R call(const Functor &cb, P1 p1, P2 p2, P3 p3) {
+      const Args &args(*(const Args*)(const void*)(cb.bound.mem));
+      Callee *callee = (Callee*)(cb.callee);
+      Method &method(*(Method*)(void*)(cb.ptr.mem));
+      return (callee->*method)(args.a1,p1,p2,p3);
+    }
+};
+
+// For 1 bound argument, 0 parameters callback
+
+template <typename P1, typename A1>
+void Bind(void (*f)(P1), A1 a1, Functor0 &cb)
+{
+  cb = BoundFunctionTranslator0_1<void (*)(P1), A1>(f, a1);
+}
+
+template <class Callee, class Calltype, typename P1, typename A1>
+void Bind(Callee *c, void (Calltype::*m)(P1), A1 a1, Functor0 &cb)
+{
+  cb = BoundMethodTranslator0_1<Callee, void (Calltype::*)(P1), A1>(c, m, a1);
+}
+
+template <class Callee, class Calltype, typename P1, typename A1>
+void Bind(const Callee *c, void (Calltype::*m)(P1) const, A1 a1, Functor0 &cb)
+{
+  cb = BoundMethodTranslator0_1<const Callee, void (Calltype::*)(P1) const, A1>(c, m, a1);
+}
+
+template <typename CR, typename R, typename P1, typename A1>
+void Bind(R (*f)(P1), A1 a1, Functor0wR<CR> &cb)
+{
+  cb = BoundFunctionTranslator0wR_1<CR, R (*)(P1), A1>(f, a1);
+}
+
+template <typename CR, class Callee, typename R, class Calltype, typename P1, typename A1>
+void Bind(Callee *c, R (Calltype::*m)(P1), A1 a1, Functor0wR<CR> &cb)
+{
+  cb = BoundMethodTranslator0wR_1<CR, Callee, R (Calltype::*)(P1), A1>(c, m, a1);
+}
+
+template <typename CR, class Callee, typename R, class Calltype, typename P1, typename A1>
+void Bind(const Callee *c, R (Calltype::*m)(P1) const, A1 a1, Functor0wR<CR> &cb)
+{
+  cb = BoundMethodTranslator0wR_1<CR, const Callee, R (Calltype::*)(P1) const, A1>(c, m, a1);
+}
+
+// For 2 bound arguments, 0 parameters callback
+
+template <typename P1, typename P2, typename A1, typename A2>
+void Bind(void (*f)(P1,P2), A1 a1, A2 a2, Functor0 &cb)
+{
+  cb = BoundFunctionTranslator0_2<void (*)(P1,P2), A1, A2>(f, a1, a2);
+}
+
+template <class Callee, class Calltype, typename P1, typename P2, typename A1, typename A2>
+void Bind(Callee *c, void (Calltype::*m)(P1,P2), A1 a1, A2 a2, Functor0 &cb)
+{
+  cb = BoundMethodTranslator0_2<Callee, void (Calltype::*)(P1,P2), A1, A2>(c, m, a1, a2);
+}
+
+template <class Callee, class Calltype, typename P1, typename P2, typename A1, typename A2>
+void Bind(const Callee *c, void (Calltype::*m)(P1,P2) const, A1 a1, A2 a2, Functor0 &cb)
+{
+  cb = BoundMethodTranslator0_2<const Callee, void (Calltype::*)(P1,P2) const, A1, A2>(c, m, a1, a2);
+}
+
+template <typename CR, typename R, typename P1, typename P2, typename A1, typename A2>
+void Bind(R (*f)(P1,P2), A1 a1, A2 a2, Functor0wR<CR> &cb)
+{
+  cb = BoundFunctionTranslator0wR_2<CR, R (*)(P1,P2), A1, A2>(f, a1, a2);
+}
+
+template <typename CR, class Callee, typename R, class Calltype, typename P1, typename P2, typename A1, typename A2>
+void Bind(Callee *c, R (Calltype::*m)(P1,P2), A1 a1, A2 a2, Functor0wR<CR> &cb)
+{
+  cb = BoundMethodTranslator0wR_2<CR, Callee, R (Calltype::*)(P1,P2), A1, A2>(c, m, a1, a2);
+}
+
+template <typename CR, class Callee, typename R, class Calltype, typename P1, typename P2, typename A1, typename A2>
+void Bind(const Callee *c, R (Calltype::*m)(P1,P2) const, A1 a1, A2 a2, Functor0wR<CR> &cb)
+{
+  cb = BoundMethodTranslator0wR_2<CR, const Callee, R (Calltype::*)(P1,P2) const, A1, A2>(c, m, a1, a2);
+}
+
+// For 3 bound arguments, 0 parameters callback
+
+template <typename P1, typename P2, typename P3, typename A1, typename A2, typename A3>
+void Bind(void (*f)(P1,P2,P3), A1 a1, A2 a2, A3 a3, Functor0 &cb)
+{
+  cb = BoundFunctionTranslator0_3<void (*)(P1,P2,P3), A1, A2, A3>(f, a1, a2, a3);
+}
+
+template <class Callee, class Calltype, typename P1, typename P2, typename P3, typename A1, typename A2, typename A3>
+void Bind(Callee *c, void (Calltype::*m)(P1,P2,P3), A1 a1, A2 a2, A3 a3, Functor0 &cb)
+{
+  cb = BoundMethodTranslator0_3<Callee, void (Calltype::*)(P1,P2,P3), A1, A2, A3>(c, m, a1, a2, a3);
+}
+
+template <class Callee, class Calltype, typename P1, typename P2, typename P3, typename A1, typename A2, typename A3>
+void Bind(const Callee *c, void (Calltype::*m)(P1,P2,P3) const, A1 a1, A2 a2, A3 a3, Functor0 &cb)
+{
+  cb = BoundMethodTranslator0_3<const Callee, void (Calltype::*)(P1,P2,P3) const, A1, A2, A3>(c, m, a1, a2, a3);
+}
+
+template <typename CR, typename R, typename P1, typename P2, typename P3, typename A1, typename A2, typename A3>
+void Bind(R (*f)(P1,P2,P3), A1 a1, A2 a2, A3 a3, Functor0wR<CR> &cb)
+{
+  cb = BoundFunctionTranslator0wR_3<CR, R (*)(P1,P2,P3), A1, A2, A3>(f, a1, a2, a3);
+}
+
+template <typename CR, class Callee, typename R, class Calltype, typename P1, typename P2, typename P3, typename A1, typename A2, typename A3>
+void Bind(Callee *c, R (Calltype::*m)(P1,P2,P3), A1 a1, A2 a2, A3 a3, Functor0wR<CR> &cb)
+{
+  cb = BoundMethodTranslator0wR_3<CR, Callee, R (Calltype::*)(P1,P2,P3), A1, A2, A3>(c, m, a1, a2, a3);
+}
+
+template <typename CR, class Callee, typename R, class Calltype, typename P1, typename P2, typename P3, typename A1, typename A2, typename A3>
+void Bind(const Callee *c, R (Calltype::*m)(P1,P2,P3) const, A1 a1, A2 a2, A3 a3, Functor0wR<CR> &cb)
+{
+  cb = BoundMethodTranslator0wR_3<CR, const Callee, R (Calltype::*)(P1,P2,P3) const, A1, A2, A3>(c, m, a1, a2, a3);
+}
+
+// For 4 bound arguments, 0 parameters callback
+
+template <typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3, typename A4>
+void Bind(void (*f)(P1,P2,P3,P4), A1 a1, A2 a2, A3 a3, A4 a4, Functor0 &cb)
+{
+  cb = BoundFunctionTranslator0_4<void (*)(P1,P2,P3,P4), A1, A2, A3, A4>(f, a1, a2, a3, a4);
+}
+
+template <class Callee, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3, typename A4>
+void Bind(Callee *c, void (Calltype::*m)(P1,P2,P3,P4), A1 a1, A2 a2, A3 a3, A4 a4, Functor0 &cb)
+{
+  cb = BoundMethodTranslator0_4<Callee, void (Calltype::*)(P1,P2,P3,P4), A1, A2, A3, A4>(c, m, a1, a2, a3, a4);
+}
+
+template <class Callee, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3, typename A4>
+void Bind(const Callee *c, void (Calltype::*m)(P1,P2,P3,P4) const, A1 a1, A2 a2, A3 a3, A4 a4, Functor0 &cb)
+{
+  cb = BoundMethodTranslator0_4<const Callee, void (Calltype::*)(P1,P2,P3,P4) const, A1, A2, A3, A4>(c, m, a1, a2, a3, a4);
+}
+
+template <typename CR, typename R, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3, typename A4>
+void Bind(R (*f)(P1,P2,P3,P4), A1 a1, A2 a2, A3 a3, A4 a4, Functor0wR<CR> &cb)
+{
+  cb = BoundFunctionTranslator0wR_4<CR, R (*)(P1,P2,P3,P4), A1, A2, A3, A4>(f, a1, a2, a3, a4);
+}
+
+template <typename CR, class Callee, typename R, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3, typename A4>
+void Bind(Callee *c, R (Calltype::*m)(P1,P2,P3,P4), A1 a1, A2 a2, A3 a3, A4 a4, Functor0wR<CR> &cb)
+{
+  cb = BoundMethodTranslator0wR_4<CR, Callee, R (Calltype::*)(P1,P2,P3,P4), A1, A2, A3, A4>(c, m, a1, a2, a3, a4);
+}
+
+template <typename CR, class Callee, typename R, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3, typename A4>
+void Bind(const Callee *c, R (Calltype::*m)(P1,P2,P3,P4) const, A1 a1, A2 a2, A3 a3, A4 a4, Functor0wR<CR> &cb)
+{
+  cb = BoundMethodTranslator0wR_4<CR, const Callee, R (Calltype::*)(P1,P2,P3,P4) const, A1, A2, A3, A4>(c, m, a1, a2, a3, a4);
+}
+
+// For 1 bound argument, 1 parameter callback
+
+template <typename CP1, typename P1, typename P2, typename A1>
+void Bind(void (*f)(P1,P2), A1 a1, Functor1<CP1> &cb)
+{
+  cb = BoundFunctionTranslator1_1<CP1, void (*)(P1,P2), A1>(f, a1);
+}
+
+template <class Callee, typename CP1, class Calltype, typename P1, typename P2, typename A1>
+void Bind(Callee *c, void (Calltype::*m)(P1,P2), A1 a1, Functor1<CP1> &cb)
+{
+  cb = BoundMethodTranslator1_1<Callee, CP1, void (Calltype::*)(P1,P2), A1>(c, m, a1);
+}
+
+template <class Callee, typename CP1, class Calltype, typename P1, typename P2, typename A1>
+void Bind(const Callee *c, void (Calltype::*m)(P1,P2) const, A1 a1, Functor1<CP1> &cb)
+{
+  cb = BoundMethodTranslator1_1<const Callee, CP1, void (Calltype::*)(P1,P2) const, A1>(c, m, a1);
+}
+
+template <typename CR, typename CP1, typename R, typename P1, typename P2, typename A1>
+void Bind(R (*f)(P1,P2), A1 a1, Functor1wR<CR,CP1> &cb)
+{
+  cb = BoundFunctionTranslator1wR_1<CR, CP1, R (*)(P1,P2), A1>(f, a1);
+}
+
+template <typename CR, class Callee, typename CP1, typename R, class Calltype, typename P1, typename P2, typename A1>
+void Bind(Callee *c, R (Calltype::*m)(P1,P2), A1 a1, Functor1wR<CR,CP1> &cb)
+{
+  cb = BoundMethodTranslator1wR_1<CR, Callee, CP1, R (Calltype::*)(P1,P2), A1>(c, m, a1);
+}
+
+template <typename CR, class Callee, typename CP1, typename R, class Calltype, typename P1, typename P2, typename A1>
+void Bind(const Callee *c, R (Calltype::*m)(P1,P2) const, A1 a1, Functor1wR<CR,CP1> &cb)
+{
+  cb = BoundMethodTranslator1wR_1<CR, const Callee, CP1, R (Calltype::*)(P1,P2) const, A1>(c, m, a1);
+}
+
+// For 2 bound arguments, 1 parameter callback
+
+template <typename CP1, typename P1, typename P2, typename P3, typename A1, typename A2>
+void Bind(void (*f)(P1,P2,P3), A1 a1, A2 a2, Functor1<CP1> &cb)
+{
+  cb = BoundFunctionTranslator1_2<CP1, void (*)(P1,P2,P3), A1, A2>(f, a1, a2);
+}
+
+template <class Callee, typename CP1, class Calltype, typename P1, typename P2, typename P3, typename A1, typename A2>
+void Bind(Callee *c, void (Calltype::*m)(P1,P2,P3), A1 a1, A2 a2, Functor1<CP1> &cb)
+{
+  cb = BoundMethodTranslator1_2<Callee, CP1, void (Calltype::*)(P1,P2,P3), A1, A2>(c, m, a1, a2);
+}
+
+template <class Callee, typename CP1, class Calltype, typename P1, typename P2, typename P3, typename A1, typename A2>
+void Bind(const Callee *c, void (Calltype::*m)(P1,P2,P3) const, A1 a1, A2 a2, Functor1<CP1> &cb)
+{
+  cb = BoundMethodTranslator1_2<const Callee, CP1, void (Calltype::*)(P1,P2,P3) const, A1, A2>(c, m, a1, a2);
+}
+
+template <typename CR, typename CP1, typename R, typename P1, typename P2, typename P3, typename A1, typename A2>
+void Bind(R (*f)(P1,P2,P3), A1 a1, A2 a2, Functor1wR<CR,CP1> &cb)
+{
+  cb = BoundFunctionTranslator1wR_2<CR, CP1, R (*)(P1,P2,P3), A1, A2>(f, a1, a2);
+}
+
+template <typename CR, class Callee, typename CP1, typename R, class Calltype, typename P1, typename P2, typename P3, typename A1, typename A2>
+void Bind(Callee *c, R (Calltype::*m)(P1,P2,P3), A1 a1, A2 a2, Functor1wR<CR,CP1> &cb)
+{
+  cb = BoundMethodTranslator1wR_2<CR, Callee, CP1, R (Calltype::*)(P1,P2,P3), A1, A2>(c, m, a1, a2);
+}
+
+template <typename CR, class Callee, typename CP1, typename R, class Calltype, typename P1, typename P2, typename P3, typename A1, typename A2>
+void Bind(const Callee *c, R (Calltype::*m)(P1,P2,P3) const, A1 a1, A2 a2, Functor1wR<CR,CP1> &cb)
+{
+  cb = BoundMethodTranslator1wR_2<CR, const Callee, CP1, R (Calltype::*)(P1,P2,P3) const, A1, A2>(c, m, a1, a2);
+}
+
+// For 3 bound arguments, 1 parameter callback
+
+template <typename CP1, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3>
+void Bind(void (*f)(P1,P2,P3,P4), A1 a1, A2 a2, A3 a3, Functor1<CP1> &cb)
+{
+  cb = BoundFunctionTranslator1_3<CP1, void (*)(P1,P2,P3,P4), A1, A2, A3>(f, a1, a2, a3);
+}
+
+template <class Callee, typename CP1, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3>
+void Bind(Callee *c, void (Calltype::*m)(P1,P2,P3,P4), A1 a1, A2 a2, A3 a3, Functor1<CP1> &cb)
+{
+  cb = BoundMethodTranslator1_3<Callee, CP1, void (Calltype::*)(P1,P2,P3,P4), A1, A2, A3>(c, m, a1, a2, a3);
+}
+
+template <class Callee, typename CP1, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3>
+void Bind(const Callee *c, void (Calltype::*m)(P1,P2,P3,P4) const, A1 a1, A2 a2, A3 a3, Functor1<CP1> &cb)
+{
+  cb = BoundMethodTranslator1_3<const Callee, CP1, void (Calltype::*)(P1,P2,P3,P4) const, A1, A2, A3>(c, m, a1, a2, a3);
+}
+
+template <typename CR, typename CP1, typename R, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3>
+void Bind(R (*f)(P1,P2,P3,P4), A1 a1, A2 a2, A3 a3, Functor1wR<CR,CP1> &cb)
+{
+  cb = BoundFunctionTranslator1wR_3<CR, CP1, R (*)(P1,P2,P3,P4), A1, A2, A3>(f, a1, a2, a3);
+}
+
+template <typename CR, class Callee, typename CP1, typename R, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3>
+void Bind(Callee *c, R (Calltype::*m)(P1,P2,P3,P4), A1 a1, A2 a2, A3 a3, Functor1wR<CR,CP1> &cb)
+{
+  cb = BoundMethodTranslator1wR_3<CR, Callee, CP1, R (Calltype::*)(P1,P2,P3,P4), A1, A2, A3>(c, m, a1, a2, a3);
+}
+
+template <typename CR, class Callee, typename CP1, typename R, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2, typename A3>
+void Bind(const Callee *c, R (Calltype::*m)(P1,P2,P3,P4) const, A1 a1, A2 a2, A3 a3, Functor1wR<CR,CP1> &cb)
+{
+  cb = BoundMethodTranslator1wR_3<CR, const Callee, CP1, R (Calltype::*)(P1,P2,P3,P4) const, A1, A2, A3>(c, m, a1, a2, a3);
+}
+
+// For 1 bound argument, 2 parameters callback
+
+template <typename CP1, typename CP2, typename P1, typename P2, typename P3, typename A1>
+void Bind(void (*f)(P1,P2,P3), A1 a1, Functor2<CP1,CP2> &cb)
+{
+  cb = BoundFunctionTranslator2_1<CP1, CP2, void (*)(P1,P2,P3), A1>(f, a1);
+}
+
+template <class Callee, typename CP1, typename CP2, class Calltype, typename P1, typename P2, typename P3, typename A1>
+void Bind(Callee *c, void (Calltype::*m)(P1,P2,P3), A1 a1, Functor2<CP1,CP2> &cb)
+{
+  cb = BoundMethodTranslator2_1<Callee, CP1, CP2, void (Calltype::*)(P1,P2,P3), A1>(c, m, a1);
+}
+
+template <class Callee, typename CP1, typename CP2, class Calltype, typename P1, typename P2, typename P3, typename A1>
+void Bind(const Callee *c, void (Calltype::*m)(P1,P2,P3) const, A1 a1, Functor2<CP1,CP2> &cb)
+{
+  cb = BoundMethodTranslator2_1<const Callee, CP1, CP2, void (Calltype::*)(P1,P2,P3) const, A1>(c, m, a1);
+}
+
+template <typename CR, typename CP1, typename CP2, typename R, typename P1, typename P2, typename P3, typename A1>
+void Bind(R (*f)(P1,P2,P3), A1 a1, Functor2wR<CR,CP1,CP2> &cb)
+{
+  cb = BoundFunctionTranslator2wR_1<CR, CP1, CP2, R (*)(P1,P2,P3), A1>(f, a1);
+}
+
+template <typename CR, class Callee, typename CP1, typename CP2, typename R, class Calltype, typename P1, typename P2, typename P3, typename A1>
+void Bind(Callee *c, R (Calltype::*m)(P1,P2,P3), A1 a1, Functor2wR<CR,CP1,CP2> &cb)
+{
+  cb = BoundMethodTranslator2wR_1<CR, Callee, CP1, CP2, R (Calltype::*)(P1,P2,P3), A1>(c, m, a1);
+}
+
+template <typename CR, class Callee, typename CP1, typename CP2, typename R, class Calltype, typename P1, typename P2, typename P3, typename A1>
+void Bind(const Callee *c, R (Calltype::*m)(P1,P2,P3) const, A1 a1, Functor2wR<CR,CP1,CP2> &cb)
+{
+  cb = BoundMethodTranslator2wR_1<CR, const Callee, CP1, CP2, R (Calltype::*)(P1,P2,P3) const, A1>(c, m, a1);
+}
+
+// For 2 bound arguments, 2 parameters callback
+
+template <typename CP1, typename CP2, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2>
+void Bind(void (*f)(P1,P2,P3,P4), A1 a1, A2 a2, Functor2<CP1,CP2> &cb)
+{
+  cb = BoundFunctionTranslator2_2<CP1, CP2, void (*)(P1,P2,P3,P4), A1, A2>(f, a1, a2);
+}
+
+template <class Callee, typename CP1, typename CP2, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2>
+void Bind(Callee *c, void (Calltype::*m)(P1,P2,P3,P4), A1 a1, A2 a2, Functor2<CP1,CP2> &cb)
+{
+  cb = BoundMethodTranslator2_2<Callee, CP1, CP2, void (Calltype::*)(P1,P2,P3,P4), A1, A2>(c, m, a1, a2);
+}
+
+template <class Callee, typename CP1, typename CP2, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2>
+void Bind(const Callee *c, void (Calltype::*m)(P1,P2,P3,P4) const, A1 a1, A2 a2, Functor2<CP1,CP2> &cb)
+{
+  cb = BoundMethodTranslator2_2<const Callee, CP1, CP2, void (Calltype::*)(P1,P2,P3,P4) const, A1, A2>(c, m, a1, a2);
+}
+
+template <typename CR, typename CP1, typename CP2, typename R, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2>
+void Bind(R (*f)(P1,P2,P3,P4), A1 a1, A2 a2, Functor2wR<CR,CP1,CP2> &cb)
+{
+  cb = BoundFunctionTranslator2wR_2<CR, CP1, CP2, R (*)(P1,P2,P3,P4), A1, A2>(f, a1, a2);
+}
+
+template <typename CR, class Callee, typename CP1, typename CP2, typename R, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2>
+void Bind(Callee *c, R (Calltype::*m)(P1,P2,P3,P4), A1 a1, A2 a2, Functor2wR<CR,CP1,CP2> &cb)
+{
+  cb = BoundMethodTranslator2wR_2<CR, Callee, CP1, CP2, R (Calltype::*)(P1,P2,P3,P4), A1, A2>(c, m, a1, a2);
+}
+
+template <typename CR, class Callee, typename CP1, typename CP2, typename R, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1, typename A2>
+void Bind(const Callee *c, R (Calltype::*m)(P1,P2,P3,P4) const, A1 a1, A2 a2, Functor2wR<CR,CP1,CP2> &cb)
+{
+  cb = BoundMethodTranslator2wR_2<CR, const Callee, CP1, CP2, R (Calltype::*)(P1,P2,P3,P4) const, A1, A2>(c, m, a1, a2);
+}
+
+// For 1 bound argument, 3 parameters callback
+
+template <typename CP1, typename CP2, typename CP3, typename P1, typename P2, typename P3, typename P4, typename A1>
+void Bind(void (*f)(P1,P2,P3,P4), A1 a1, Functor3<CP1,CP2,CP3> &cb)
+{
+  cb = BoundFunctionTranslator3_1<CP1, CP2, CP3, void (*)(P1,P2,P3,P4), A1>(f, a1);
+}
+
+template <class Callee, typename CP1, typename CP2, typename CP3, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1>
+void Bind(Callee *c, void (Calltype::*m)(P1,P2,P3,P4), A1 a1, Functor3<CP1,CP2,CP3> &cb)
+{
+  cb = BoundMethodTranslator3_1<Callee, CP1, CP2, CP3, void (Calltype::*)(P1,P2,P3,P4), A1>(c, m, a1);
+}
+
+template <class Callee, typename CP1, typename CP2, typename CP3, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1>
+void Bind(const Callee *c, void (Calltype::*m)(P1,P2,P3,P4) const, A1 a1, Functor3<CP1,CP2,CP3> &cb)
+{
+  cb = BoundMethodTranslator3_1<const Callee, CP1, CP2, CP3, void (Calltype::*)(P1,P2,P3,P4) const, A1>(c, m, a1);
+}
+
+template <typename CR, typename CP1, typename CP2, typename CP3, typename R, typename P1, typename P2, typename P3, typename P4, typename A1>
+void Bind(R (*f)(P1,P2,P3,P4), A1 a1, Functor3wR<CR,CP1,CP2,CP3> &cb)
+{
+  cb = BoundFunctionTranslator3wR_1<CR, CP1, CP2, CP3, R (*)(P1,P2,P3,P4), A1>(f, a1);
+}
+
+template <typename CR, class Callee, typename CP1, typename CP2, typename CP3, typename R, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1>
+void Bind(Callee *c, R (Calltype::*m)(P1,P2,P3,P4), A1 a1, Functor3wR<CR,CP1,CP2,CP3> &cb)
+{
+  cb = BoundMethodTranslator3wR_1<CR, Callee, CP1, CP2, CP3, R (Calltype::*)(P1,P2,P3,P4), A1>(c, m, a1);
+}
+
+template <typename CR, class Callee, typename CP1, typename CP2, typename CP3, typename R, class Calltype, typename P1, typename P2, typename P3, typename P4, typename A1>
+void Bind(const Callee *c, R (Calltype::*m)(P1,P2,P3,P4) const, A1 a1, Functor3wR<CR,CP1,CP2,CP3> &cb)
+{
+  cb = BoundMethodTranslator3wR_1<CR, const Callee, CP1, CP2, CP3, R (Calltype::*)(P1,P2,P3,P4) const, A1>(c, m, a1);
+}
+
 }
 
 #endif
@@ -33,6 +33,11 @@ SOFTWARE.
 
 namespace gcore {
   
+  class ThreadPool;
+  
+  // Implements List parallel methods, defined in gcore/threadpool.h
+  template <class L> class ParallelList;
+  
   template <class T, bool Contiguous=true, class Allocator=std::allocator<T> >
   class List : public TCond<Contiguous, std::vector<T, Allocator>, std::deque<T, Allocator> >::Type {
     public:
@@ -103,6 +108,26 @@ namespace gcore {
         return val;
       }
       
+      // Parallel versions of filter, map and reduce: gcore/threadpool.h must be
+      // included to use them. Elements are processed by chunks of 'grain'
+      // elements (0 picks a size based on the pool worker count), the calling
+      // thread helps running the tasks. func must be thread safe and for
+      // parallelReduce, associative.
+      
+      ThisType& parallelFilter(ThreadPool &pool, FilterFunc func, size_t grain=0) {
+        ParallelList<ThisType>::Filter(*this, pool, func, grain);
+        return *this;
+      }
+      
+      ThisType& parallelMap(ThreadPool &pool, MapFunc func, size_t grain=0) {
+        ParallelList<ThisType>::Map(*this, pool, func, grain);
+        return *this;
+      }
+      
+      T parallelReduce(ThreadPool &pool, ReduceFunc func, const T &initVal=T(), size_t grain=0) const {
+        return ParallelList<ThisType>::Reduce(*this, pool, func, initVal, grain);
+      }
+      
       inline void push(const T &val) {
         BaseType::push_back(val);
       }
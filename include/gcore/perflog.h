@@ -33,6 +33,7 @@ SOFTWARE.
 namespace gcore
 {
    class GCORE_API Log;
+   class GCORE_API Mutex;
    
    class GCORE_API PerfLog
    {
@@ -47,7 +48,17 @@ namespace gcore
          MilliSeconds,
          Seconds,
          Minutes,
-         Hours
+         Hours,
+         // raw counter of the clock source, what threads logs keep
+         Ticks
+      };
+      
+      enum ClockSource
+      {
+         // monotonic wall time (performance counter on windows)
+         DefaultClock = 0,
+         // invariant time stamp counter (x86), wall time
+         TSCClock
       };
       
       enum ShowFlags
@@ -59,8 +70,10 @@ namespace gcore
          ShowNumCalls = 0x10,
          ShowDetailed = 0x20,
          ShowFlat = 0x40,
+         // p50, p90, p99 and max of the calls total time
+         ShowPercentiles = 0x80,
          ShowDefaults = ShowTotalTime,
-         ShowAll = ShowTotalTime|ShowFuncTime|ShowAvgTotalTime|ShowAvgFuncTime|ShowNumCalls
+         ShowAll = ShowTotalTime|ShowFuncTime|ShowAvgTotalTime|ShowAvgFuncTime|ShowNumCalls|ShowPercentiles
       };
       
       enum SortCriteria
@@ -71,6 +84,10 @@ namespace gcore
          SortAvgTotalTime,
          SortAvgFuncTime,
          SortNumCalls,
+         SortP50,
+         SortP90,
+         SortP99,
+         SortMaxTime,
          SortReverse = 0x1000
       };
       
@@ -80,18 +97,136 @@ namespace gcore
          LogOutput
       };
       
+      // Identifier registered once (per call site, usually a static) and
+      // passed to begin instead of a string: the log then finds its entries
+      // by index rather than by name lookups (see GCORE_PERFLOG_SCOPE)
+      class GCORE_API Probe
+      {
+      public:
+         
+         Probe(const std::string &id);
+         
+         inline const std::string& id() const
+         {
+            return mId;
+         }
+         
+         inline size_t index() const
+         {
+            return mIndex;
+         }
+         
+      private:
+         
+         Probe();
+         Probe(const Probe &);
+         Probe& operator=(const Probe &);
+         
+         std::string mId;
+         size_t mIndex;
+      };
+      
+      // Scope recorded on end() while event recording is on (see recordEvents)
+      struct Event
+      {
+         std::string id;
+         // monotonic wall clock, in seconds
+         double start;
+         double duration;
+         // nesting level in its thread
+         size_t depth;
+         // 1 for the first thread log created, 2 for the next... 0 otherwise
+         size_t thread;
+      };
+      
+      typedef std::vector<Event> EventList;
+      
+      // Fixed size log-linear histogram of calls durations (HDR style): the
+      // nanoseconds are bucketed by power of 2, each one split in SubBuckets
+      // linear buckets, so that percentiles are within 1/SubBuckets of the
+      // actual value and histograms can be merged exactly
+      class GCORE_API Histogram
+      {
+      public:
+         
+         enum
+         {
+            SubBucketBits = 3,
+            SubBuckets = 1 << SubBucketBits,
+            // up to 2^(Magnitudes+SubBucketBits) ns (~2.4 hours)
+            Magnitudes = 40,
+            NumBuckets = (Magnitudes + 1) * SubBuckets
+         };
+         
+         Histogram();
+         
+         void clear();
+         void add(double nanoseconds, size_t count=1);
+         void merge(const Histogram &rhs);
+         
+         // q in [0, 1], in nanoseconds
+         double percentile(double q) const;
+         
+         inline size_t count() const
+         {
+            return mCount;
+         }
+         
+         inline double max() const
+         {
+            return mMax;
+         }
+         
+      private:
+         
+         static size_t Bucket(double nanoseconds);
+         static double BucketValue(size_t bucket);
+         
+         unsigned int mCounts[NumBuckets];
+         size_t mCount;
+         double mMax;
+      };
+      
    public:
       
+      // Each thread gets its own log, only locked by the thread itself and
+      // while a snapshot is taken. Logs of exited threads are merged into a
+      // common one. The static functions apply to the calling thread's log
+      // except Print and Clear that apply to all of them
+      static PerfLog& ThreadInstance();
+      // same as ThreadInstance
       static PerfLog& SharedInstance();
+      // merge all the threads logs into plog
+      static void Snapshot(PerfLog &plog);
       static void Begin(const std::string &id);
+      static void Begin(const Probe &probe);
       static void End();
       static void Print(Output output=ConsoleOutput, int flags=ShowDefaults, int sortBy=SortFuncTime, Units units=CurrentUnits);
       static void Print(std::ostream &os, int flags=ShowDefaults, int sortBy=SortFuncTime, Units units=CurrentUnits);
       static void Print(Log &log, int flags=ShowDefaults, int sortBy=SortFuncTime, Units units=CurrentUnits);
       static void Clear();
+      // Turn event recording on for all threads logs, current and future ones
+      // (0 turns it off). Events of exited threads share one extra ring
+      static void RecordEvents(size_t capacity);
+      // all the threads recorded events
+      static void Events(EventList &events);
+      // write all the threads events as Chrome Trace Event JSON
+      static void WriteChromeTrace(std::ostream &os);
+      // write the merged threads call paths in folded stacks format
+      static void WriteFoldedStacks(std::ostream &os);
+      static void WriteChromeTrace(const EventList &events, std::ostream &os);
       
       static const char* UnitsString(Units units);
       static double ConvertUnits(double val, Units srcUnits, Units dstUnits);
+      // Select the clock all logs read on begin/end, at startup: switching
+      // clears all threads logs as ticks of both clocks don't compare, and is
+      // refused (false returned, clock kept) while a scope is open in any of
+      // them. Logs created by the caller must not be timing scopes either. The
+      // TSC is calibrated against the monotonic clock when first selected,
+      // false is returned if the CPU has no invariant TSC
+      static bool SetClockSource(ClockSource src);
+      static ClockSource GetClockSource();
+      static double TicksPerSecond();
       
       
    public:
@@ -103,6 +238,7 @@ namespace gcore
       PerfLog& operator=(const PerfLog&);
       
       void begin(const std::string &id);
+      void begin(const Probe &probe);
       void end();
       void print(Output output=ConsoleOutput, int flags=ShowDefaults, int sortBy=SortFuncTime, Units units=CurrentUnits);
       void print(std::ostream &os, int flags=ShowDefaults, int sortBy=SortFuncTime, Units units=CurrentUnits);
@@ -110,6 +246,23 @@ namespace gcore
       void clear();
       bool empty() const;
       void merge(const PerfLog &rhs);
+      // account a duration measured elsewhere as 'count' calls of id, at the
+      // current level (pending entries times are not affected)
+      void add(const std::string &id, double duration, size_t count=1, Units units=Seconds);
+      // Keep the last 'capacity' scopes timeline in a ring buffer (0 turns
+      // recording off, the default). Costs an extra clock read per scope
+      void recordEvents(size_t capacity);
+      inline size_t eventsCapacity() const
+      {
+         return mEvents.size();
+      }
+      // append recorded events, oldest first
+      void events(EventList &events) const;
+      // View in chrome://tracing or Perfetto (ui.perfetto.dev)
+      void writeChromeTrace(std::ostream &os) const;
+      // One 'caller;callee microseconds' line per call path with its self
+      // time, the input of flamegraph.pl or speedscope
+      void writeFoldedStacks(std::ostream &os) const;
       
    public:
       
@@ -120,6 +273,8 @@ namespace gcore
          double totalTime;
          double selfTime;
          size_t callCount;
+         // calls total time distribution (recursive calls count once)
+         Histogram durations;
       
          BaseEntry();
          BaseEntry(const BaseEntry &);
@@ -133,6 +288,8 @@ namespace gcore
       public:
       
          std::map<std::string, Entry> subs;
+         // subs by probe index (not copied)
+         std::vector<Entry*> probeSubs;
       
          Entry();
          Entry(const Entry &);
@@ -144,31 +301,40 @@ namespace gcore
       class GCORE_API StackItem
       {
       public:
-         #ifdef _WIN32
-         typedef LARGE_INTEGER TimeCounter;
-         #else
-         typedef struct timespec TimeCounter;
-         #endif
+         // clock source ticks
+         typedef UInt64 TimeCounter;
       
          Entry *entry;
-         std::string id;
+         // flat entry and its key
+         BaseEntry *global;
+         const std::string *id;
          int recursionCount;
          TimeCounter start;
          TimeCounter selfStart;
+         // event recording start
+         double wallStart;
       
          StackItem();
-         StackItem(const std::string &_id, Entry *_entry);
+         StackItem(const std::string *_id, BaseEntry *_global, Entry *_entry);
+         StackItem(const std::string *_id, BaseEntry *_global, Entry *_entry, const TimeCounter &now);
          StackItem(const StackItem &);
          StackItem& operator=(const StackItem &);
       
+         // the variants taking the current time let begin/end read the clock once
          void stopAll(double &total, double &self, Units units);
+         void stopAll(const TimeCounter &now, double &total, double &self, Units units);
          double stopSelf(Units units);
+         double stopSelf(const TimeCounter &now, Units units);
          void startSelf();
+         void startSelf(const TimeCounter &now);
          double duration(Units units) const;
+         
+         static void Now(TimeCounter &tc);
       
       private:
       
          double duration(const TimeCounter &from, Units units) const;
+         static double Elapsed(const TimeCounter &from, const TimeCounter &to, Units units);
       
          bool selfStopped;
       };
@@ -176,11 +342,41 @@ namespace gcore
       typedef std::map<std::string, BaseEntry> BaseEntryMap;
       typedef std::map<std::string, Entry> EntryMap;
       
+      // flat and per call path entries
+      inline const BaseEntryMap& entries() const
+      {
+         return mEntries;
+      }
+      
+      inline const EntryMap& rootEntries() const
+      {
+         return mRootEntries;
+      }
+      
       
    private:
       
+      friend class ThreadPerfLog;
+      
+      // entries of a probe, filled on first use
+      struct ProbeEntries
+      {
+         BaseEntry *global;
+         const std::string *id;
+         Entry *root;
+      };
+      
+      void lock() const;
+      void unlock() const;
+      // clear, log locked
+      void _clear();
+      void begin(const std::string &id, size_t probe);
+      void appendEvent(const Event &evt);
+      
       const char* unitsString(Units units) const;
       double convertUnits(double val, Units srcUnits, Units dstUnits) const;
+      // print units, logs in ticks are shown in seconds by default
+      Units displayUnits(Units units) const;
       
       
    private:
@@ -188,7 +384,15 @@ namespace gcore
       BaseEntryMap mEntries;
       EntryMap mRootEntries;
       std::deque<StackItem> mEntryStack;
+      std::vector<ProbeEntries> mProbes;
+      // event ring buffer
+      EventList mEvents;
+      size_t mNextEvent;
+      size_t mNumEvents;
+      size_t mThread;
       Units mUnits;
+      // set for threads logs
+      Mutex *mLock;
    };
 
    class GCORE_API ScopedPerfLog
@@ -197,6 +401,8 @@ namespace gcore
    
       ScopedPerfLog(const std::string &msg);
       ScopedPerfLog(PerfLog &plog, const std::string &msg);
+      ScopedPerfLog(const PerfLog::Probe &probe);
+      ScopedPerfLog(PerfLog &plog, const PerfLog::Probe &probe);
       ~ScopedPerfLog();
    
    private:
@@ -209,5 +415,14 @@ namespace gcore
    };
 }
 
+#define GCORE_PERFLOG_CONCAT_(a, b) a##b
+#define GCORE_PERFLOG_CONCAT(a, b) GCORE_PERFLOG_CONCAT_(a, b)
+
+// Time the enclosing scope in the calling thread's log, id is only looked up
+// the first time the scope is entered
+#define GCORE_PERFLOG_SCOPE(id) \
+   static gcore::PerfLog::Probe GCORE_PERFLOG_CONCAT(_perfLogProbe, __LINE__)(id); \
+   gcore::ScopedPerfLog GCORE_PERFLOG_CONCAT(_perfLogScope, __LINE__)(GCORE_PERFLOG_CONCAT(_perfLogProbe, __LINE__))
+
 #endif
 
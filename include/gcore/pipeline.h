@@ -0,0 +1,155 @@
+/*
+MIT License
+
+Copyright (c) 2009 Gaetan Guidet
+
+This file is part of gcore.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gcore_pipeline_h_
+#define __gcore_pipeline_h_
+
+#include <gcore/threadpool.h>
+#include <map>
+
+namespace gcore {
+  
+  // A stage gets an item and returns the item to pass to the next stage, 0
+  // drops it (the remaining stages won't see it)
+  typedef Functor1wR<void*, void*> StageFunc;
+  
+  // Items read by an input stage flow through a chain of processing stages
+  // run as ThreadPool tasks, so that stages work on different items at the
+  // same time (overlapping I/O and computation).
+  // At most maxItems items are in flight: reading stops until an item leaves
+  // the last stage. This bounds the items waiting in front of serial stages as
+  // well as the memory they hold, and slows a fast input down to the pace of
+  // the slowest stage (back-pressure).
+  // The thread calling run helps with the pool tasks until the input is
+  // exhausted and all the items went through the pipeline.
+  class GCORE_API Pipeline {
+    
+    public:
+      
+      enum StageMode {
+        // one item at a time, in input order
+        SM_SERIAL_IN_ORDER = 0,
+        // one item at a time, as they come
+        SM_SERIAL_OUT_OF_ORDER,
+        // any number of items at once
+        SM_PARALLEL
+      };
+      
+      Pipeline(ThreadPool &pool);
+      
+      // waits for the current run to complete
+      ~Pipeline();
+      
+      // The input stage is called with 0 and returns the next item, or 0 once
+      // there is nothing left to read. It is always run serially
+      void input(StageFunc func);
+      
+      // Stages are run in the order they were added, the value returned by the
+      // last one is ignored (it should release the item)
+      void addStage(StageFunc func, StageMode mode=SM_PARALLEL);
+      
+      size_t numStages() const;
+      
+      // removes the input and all the stages (not while running)
+      void clear();
+      
+      // Returns the number of items read, 0 if there is no input or already
+      // running. Without pool workers, items are processed one at a time in the
+      // calling thread
+      size_t run(size_t maxItems);
+      
+      // stop reading, the items in flight still go through the remaining stages
+      void cancel();
+      
+      bool running();
+      
+      // highest number of items in flight during the last run
+      size_t peakItems();
+      
+    private:
+      
+      class Token;
+      
+      struct Stage {
+        StageFunc func;
+        StageMode mode;
+        Mutex access;
+        // an item is being processed (serial stages)
+        bool busy;
+        // sequence number of the next item (in order stages)
+        size_t next;
+        // items waiting for their turn, by sequence number
+        std::map<size_t, Token*> waiting;
+      };
+      
+      class Token {
+        public:
+          
+          Token(Pipeline *pipeline, void *item, size_t seq);
+          
+          void run();
+          
+        private:
+          
+          friend class Pipeline;
+          
+          Pipeline *mPipeline;
+          void *mItem;
+          size_t mSeq;
+          size_t mStage;
+          // already owns its (serial) stage
+          bool mResumed;
+      };
+      
+      friend class Token;
+      
+      Pipeline(const Pipeline &);
+      Pipeline& operator=(const Pipeline &);
+      
+      void submit(Token *token);
+      void read();
+      void process(Token *token);
+      void release(Token *token);
+      
+    private:
+      
+      ThreadPool &mPool;
+      TaskGroup mGroup;
+      StageFunc mInput;
+      bool mHasInput;
+      std::vector<Stage*> mStages;
+      Mutex mAccess;
+      size_t mMaxItems;
+      size_t mInFlight;
+      size_t mPeak;
+      size_t mRead;
+      bool mReading;
+      bool mExhausted;
+      bool mRunning;
+  };
+}
+
+#endif
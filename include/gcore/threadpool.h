@@ -36,11 +36,109 @@ namespace gcore {
   
   const Functor0 NullTask;
   
+  template <typename R> class Future;
+  
+  class PerfLog;
+  
   class GCORE_API ThreadPool {
     
     public:
+      
+      enum Scheduling {
+        // all workers pull from a single mutex guarded queue
+        SCH_SHARED_QUEUE = 0,
+        // each worker owns a task deque, idle workers steal from their peers
+        // and the pool queue is only used to inject new tasks
+        SCH_WORK_STEALING
+      };
+      
+      enum Placement {
+        // workers run wherever the system puts them
+        PL_NONE = 0,
+        // each worker is pinned to a processor, filling NUMA nodes one by one
+        PL_COMPACT,
+        // each worker is pinned to a processor, spreading workers across nodes
+        PL_SCATTER,
+        // workers are pinned to a NUMA node (any of its processors) and form
+        // a sub-pool with its own task queue (see runTaskOnNode)
+        PL_NUMA_NODES
+      };
+      
+      // Pending tasks are run by lane, highest priority first
+      enum Priority {
+        PRI_HIGH = 0,
+        PRI_NORMAL,
+        PRI_LOW
+      };
+      
+      static const size_t NumPriorities = PRI_LOW + 1;
+      
+      // Per priority lane counters (see queueStats)
+      struct QueueStats {
+        // tasks currently waiting in the lane
+        size_t pending;
+        // highest number of pending tasks seen in a single queue
+        size_t peak;
+        // total number of tasks queued in the lane
+        size_t queued;
+        // tasks run ahead of higher priority ones by starvation protection
+        size_t promoted;
+      };
+      
+      // Bucket i of a stats histogram counts durations below 2^i microseconds
+      // (and above the previous bucket's bound), the last one is open ended
+      static const size_t NumHistogramBuckets = 24;
+      
+      // Counters of a single worker (see stats). Times are in seconds and only
+      // collected while collectStats is on
+      struct WorkerStats {
+        // tasks run, including the ones run while helping (runPendingTask)
+        size_t executed;
+        // tasks taken from other workers deques (work stealing mode)
+        size_t steals;
+        // tasks taken from the pool queues and the time they waited there
+        size_t dequeued;
+        double queuedTime;
+        double maxQueuedTime;
+        // time spent running tasks, and the rest of the time the worker thread
+        // was alive (retired workers aren't idle)
+        double runningTime;
+        double idleTime;
+        size_t queuedHistogram[NumHistogramBuckets];
+        size_t runningHistogram[NumHistogramBuckets];
+        
+        WorkerStats() {
+          reset();
+        }
+        
+        void reset() {
+          executed = 0;
+          steals = 0;
+          dequeued = 0;
+          queuedTime = 0.0;
+          maxQueuedTime = 0.0;
+          runningTime = 0.0;
+          idleTime = 0.0;
+          for (size_t i=0; i<NumHistogramBuckets; ++i) {
+            queuedHistogram[i] = 0;
+            runningHistogram[i] = 0;
+          }
+        }
+      };
+      
+      struct Stats {
+        // seconds since the stats were turned on or reset
+        double elapsed;
+        // tasks run by threads that aren't workers (runPendingTask)
+        size_t helped;
+        // sum of all workers counters, including the ones of workers removed
+        // since the last reset
+        WorkerStats total;
+        // current workers
+        std::vector<WorkerStats> workers;
+      };
     
-      ThreadPool();
+      ThreadPool(Scheduling sched=SCH_SHARED_QUEUE);
       
       ~ThreadPool();
 
@@ -52,8 +150,33 @@ namespace gcore {
 
       bool stop();
       
+      // Can be called from any thread while the pool is running (or waiting).
+      // When called from one of the pool's workers in work stealing mode, the
+      // task is pushed on the calling worker's own deque so that a task can
+      // fork child tasks cheaply (idle workers will steal them)
       bool runTask(Task task, bool wait=true);
       
+      // Queue a task in the given priority lane. With a non zero deadline
+      // [milliseconds from now], the task runs before the lane's tasks without
+      // one, deadline tasks being ordered earliest first. Only PRI_NORMAL tasks
+      // without deadline stay on the calling worker's deque in work stealing mode
+      bool runTask(Task task, Priority prio, unsigned long deadline=0);
+      
+      // With PL_NUMA_NODES placement, queue a task for the workers of the given
+      // node only [node is taken modulo numNodes()]. Tasks queued from a worker
+      // with runTask also stay on its node. Other placements just call runTask
+      bool runTaskOnNode(size_t node, Task task, Priority prio=PRI_NORMAL);
+      
+      // Execute one pending task in the calling thread (any thread).
+      // Returns false if no task was available
+      bool runPendingTask();
+      
+      // Run func as a task, its return value is available through the returned
+      // future. The future is invalid if the task could not be queued.
+      // R cannot be void, use runTask or a TaskGroup instead
+      template <typename R>
+      Future<R> submit(Functor0wR<R> func);
+      
       bool addWorkers(size_t n);
       
       bool removeWorkers(size_t n);
@@ -61,6 +184,70 @@ namespace gcore {
       size_t numIdleWorkers();
 
       size_t numWorkers();
+      
+      // can only be changed while the pool is stopped
+      bool scheduling(Scheduling sched);
+      
+      inline Scheduling scheduling() const {
+        return mScheduling;
+      }
+      
+      // can only be changed while the pool is stopped
+      bool placement(Placement p);
+      
+      inline Placement placement() const {
+        return mPlacement;
+      }
+      
+      // number of node queues (PL_NUMA_NODES placement), 1 otherwise
+      size_t numNodes();
+      
+      // Elastic mode (maxWorkers > 0): start() clamps the number of workers to
+      // [minWorkers, maxWorkers]. Workers above minWorkers retire after being
+      // idle for idleTimeout milliseconds, and a retired worker is brought back
+      // when the pool queue made no progress for maxLatency milliseconds (tasks
+      // blocked on I/O for instance). A maxLatency of 0 disables growth.
+      // Can only be changed while the pool is stopped
+      bool elastic(size_t minWorkers, size_t maxWorkers,
+                   unsigned long idleTimeout=10000, unsigned long maxLatency=50);
+      
+      inline bool elastic() const {
+        return (mMaxWorkers > 0);
+      }
+      
+      // A lower priority lane that has been passed over 'count' times while
+      // not empty runs its next task ahead of the higher lanes. 0 disables the
+      // protection (strict priorities). Default is 16
+      void starvationLimit(size_t count);
+      
+      size_t starvationLimit();
+      
+      // lane counters, summed over the pool and node queues except for peak,
+      // the highest of their peaks
+      QueueStats queueStats(Priority prio);
+      
+      size_t numPendingTasks();
+      
+      // Time tasks queueing and running (counts are always collected). Off by
+      // default, it costs a couple of clock reads per task
+      void collectStats(bool on);
+      
+      inline bool collectStats() const {
+        return mCollectStats;
+      }
+      
+      void resetStats();
+      
+      // consistent snapshot of the pool counters
+      Stats stats();
+      
+      // Add the pool counters to plog as prefix.queued, prefix.running,
+      // prefix.idle and prefix.steals entries, and the same per worker
+      // (prefix.worker<index>.*)
+      void logStats(PerfLog &plog, const std::string &prefix="ThreadPool");
+      
+      // pool the calling thread is a worker of, 0 if not called from a task
+      static ThreadPool* Current();
 
     protected:
 
@@ -69,15 +256,38 @@ namespace gcore {
         
           Thread *mThr;
           ThreadPool *mPool;
-          bool mProcessing;
+          Atomic<bool> mProcessing;
+          size_t mIndex;
+          // NUMA node the worker runs on, also its node queue index with
+          // PL_NUMA_NODES placement when below numNodes()
+          size_t mNode;
+          Thread::CPUSet mCPUs;
+          // work stealing mode only
+          std::deque<Task> mTasks;
+          size_t mSpawned;
+          size_t mCompleted;
+          Mutex mTasksAccess;
+          // elastic mode, thread retired (protected by mTasksAccess of the pool)
+          bool mRetired;
+          // thread returned (protected by mWorkersAccess of the pool)
+          bool mExited;
+          // protected by mTasksAccess
+          WorkerStats mStats;
+          // time the thread was alive before mAliveSince, and start of the
+          // current run (0 if not running). Protected by mTasksAccess
+          double mAliveTime;
+          double mAliveSince;
         
         public:
           
           friend class ThreadPool;
         
-          Worker(ThreadPool *p);
+          Worker(ThreadPool *p, size_t index, size_t node, const Thread::CPUSet &cpus);
           ~Worker();
           
+          // start (or restart once retired) the worker thread
+          void spawn();
+          
           inline bool processing() const {
             return mProcessing;
           }
@@ -90,19 +300,127 @@ namespace gcore {
           inline void processing(bool p) {
             mProcessing = p;
           }
+          
+          // pop from the back of the local deque (most recently pushed)
+          bool popTask(Task &t);
+          // pop from the front of the local deque (oldest task)
+          bool stealTask(Task &t);
+          // push a child task at the back of the local deque
+          void pushTask(const Task &t);
       };
       
       friend class Worker;
       
+      // Pending tasks, one FIFO and one deadline heap per priority lane.
+      // Not thread safe, guarded by mTasksAccess
+      class TaskQueue {
+        public:
+          
+          TaskQueue();
+          
+          // deadline is an absolute time in seconds (see Now), 0 for none.
+          // queued is the current time when stats are collected, 0 otherwise
+          void push(const Task &t, Priority prio, double deadline=0.0, double queued=0.0);
+          
+          // Next task to run, starving lanes first. queued is set to the time
+          // the task was pushed (0 if that wasn't recorded)
+          bool pop(Task &t, size_t starvationLimit, Priority *prio=0, double *queued=0);
+          
+          // next task to run from the given lane only
+          bool pop(Task &t, Priority prio, double *queued=0);
+          
+          // move all of q tasks at the end of their respective lanes
+          void append(TaskQueue &q);
+          
+          size_t size() const;
+          
+          size_t size(Priority prio) const;
+          
+          void addStats(Priority prio, QueueStats &stats) const;
+        
+        private:
+          
+          struct QueuedTask {
+            Task task;
+            double queued;
+          };
+          
+          struct DeadlineTask {
+            double deadline;
+            double queued;
+            // submission order, keeps equal deadlines FIFO
+            size_t seq;
+            Task task;
+            
+            // heap functions put the greatest element first, reverse ordering
+            inline bool operator<(const DeadlineTask &rhs) const {
+              return (deadline != rhs.deadline ? deadline > rhs.deadline : seq > rhs.seq);
+            }
+          };
+          
+          struct Lane {
+            std::deque<QueuedTask> tasks;
+            std::vector<DeadlineTask> deadlines;
+            size_t skipped;
+            size_t peak;
+            size_t queued;
+            size_t promoted;
+          };
+          
+          Lane mLanes[NumPriorities];
+          size_t mSize;
+          size_t mSeq;
+      };
+      
     protected:
       
       Task getTask(Worker *wt);
+      
+      // pending tasks wt may pick from (its node queue first)
+      TaskQueue* pendingTasks(Worker *wt);
+      
+      // queue of the node wt is pinned to, 0 if that node has none
+      // (mTasksAccess locked)
+      TaskQueue* nodeTasks(Worker *wt);
+      
+      Task getStealingTask(Worker *wt);
+      
+      // Wait for tasks (mTasksAccess locked). Returns false once wt was idle for
+      // the elastic idle timeout, the caller has to retire it
+      bool idleWait(Worker *wt, double &idleSince);
+      
+      // elastic mode, runs the growth check until the pool is stopped
+      int monitor();
+      
+      void monitorDone(int);
+      
+      bool spawnWorker();
+      
+      bool steal(Worker *thief, Task &t);
 
-      void notifyTaskDone(Worker *wt);
+      // start is the time the task started if stats are collected, 0 otherwise
+      void notifyTaskDone(Worker *wt, double start);
+      
+      // current time if stats are collected, 0 otherwise
+      double statsTime() const;
+      
+      // account a task taken from a pool queue (wt->mTasksAccess locked)
+      void dequeued(Worker *wt, double queued, double now);
+      
+      // worker thread started or returned
+      void notifyAlive(Worker *wt, bool alive);
+      
+      // copy of wt counters with idle time derived from its alive time
+      // (wt->mTasksAccess locked)
+      WorkerStats workerStats(Worker *wt, double now);
 
       void notifyDone(Worker *wt);
       
       size_t _numIdleWorkers();
+      
+      size_t _numPendingTasks();
+      
+      bool _allTasksDone();
 
     protected:
       
@@ -112,11 +430,44 @@ namespace gcore {
         TPS_WAITING
       };
       
-      State mState;
+      // read without lock by workers and submitting tasks
+      Atomic<int> mState;
+      Scheduling mScheduling;
+      Placement mPlacement;
       ThreadID mDriverThread;
       List<Worker*> mWorkers;
-      std::deque<Task> mTasks;
+      size_t mRunningWorkers;
+      TaskQueue mTasks;
+      // PL_NUMA_NODES only, one queue per node (protected by mTasksAccess)
+      std::vector<TaskQueue> mNodeTasks;
+      size_t mStarvationLimit;
       size_t mRestartWorkersCount;
+      // tasks being run by threads that aren't workers (runPendingTask)
+      size_t mRunningHelpers;
+      // work stealing mode only
+      size_t mSubmitted;
+      size_t mHelpersCompleted;
+      size_t mTasksEpoch;
+      // workers that found no task and are about to sleep
+      Atomic<size_t> mSleepingWorkers;
+      // elastic mode only
+      size_t mMinWorkers;
+      size_t mMaxWorkers;
+      unsigned long mIdleTimeout;
+      unsigned long mMaxLatency;
+      size_t mActiveWorkers;
+      // last time a task was taken from (or pushed to an empty) pool queue
+      double mLastProgress;
+      Thread *mMonitor;
+      bool mMonitorRunning;
+      Condition mMonitorWake;
+      // read without lock by workers
+      Atomic<bool> mCollectStats;
+      // protected by mWorkersAccess
+      double mStatsStart;
+      WorkerStats mPastStats;
+      // protected by mTasksAccess
+      size_t mHelped;
       
       Mutex mWorkersAccess;
       Condition mWorkersChanged;
@@ -126,6 +477,467 @@ namespace gcore {
       
   };
   
+  // A set of tasks that can be waited on independently of the other tasks
+  // running in the pool. Waiting threads help running pending pool tasks.
+  class GCORE_API TaskGroup {
+    
+    public:
+      
+      TaskGroup(ThreadPool &pool);
+      
+      // waits for the group tasks to complete
+      ~TaskGroup();
+      
+      // can be called from any thread, including from the group tasks
+      bool run(Task task);
+      
+      // Run pending pool tasks in the calling thread until all of the group
+      // tasks are done, sleep only when there is nothing left to help with
+      void wait();
+      
+      bool done();
+      
+      size_t numPendingTasks();
+      
+    private:
+      
+      class Item {
+        public:
+          
+          Item(TaskGroup *group, Task task);
+          
+          void run();
+        
+        private:
+          
+          TaskGroup *mGroup;
+          Task mTask;
+      };
+      
+      friend class Item;
+      
+      void notifyTaskDone();
+      
+      TaskGroup(const TaskGroup &);
+      TaskGroup& operator=(const TaskGroup &);
+      
+    private:
+      
+      ThreadPool &mPool;
+      size_t mPending;
+      Mutex mAccess;
+      Condition mDone;
+  };
+  
+  // Future implementation details
+  
+  template <typename R>
+  class FutureCallback {
+    public:
+      virtual ~FutureCallback() {}
+      // called once the source future value is set
+      virtual void schedule() = 0;
+  };
+  
+  template <typename R>
+  class FutureState {
+    
+    public:
+      
+      FutureState(ThreadPool *pool)
+        : mPool(pool), mReady(false), mRefCount(1) {
+      }
+      
+      ~FutureState() {
+        for (size_t i=0; i<mCallbacks.size(); ++i) {
+          delete mCallbacks[i];
+        }
+      }
+      
+      void ref() {
+        mRefCount.fetchAdd(1, MO_RELAXED);
+      }
+      
+      void unref() {
+        // acquire other owners' writes before deleting
+        if (mRefCount.fetchSub(1, MO_ACQ_REL) == 1) {
+          delete this;
+        }
+      }
+      
+      void set(const R &val) {
+        std::vector<FutureCallback<R>*> callbacks;
+        mAccess.lock();
+        mValue = val;
+        mReady = true;
+        callbacks.swap(mCallbacks);
+        mReadyChanged.notifyAll();
+        mAccess.unlock();
+        // value is never modified once ready, no need to hold the lock
+        for (size_t i=0; i<callbacks.size(); ++i) {
+          callbacks[i]->schedule();
+        }
+      }
+      
+      // returns false if already ready, the caller then has to schedule it
+      bool addCallback(FutureCallback<R> *cb) {
+        ScopeLock lock(mAccess);
+        if (mReady) {
+          return false;
+        }
+        mCallbacks.push_back(cb);
+        return true;
+      }
+      
+      bool ready() {
+        ScopeLock lock(mAccess);
+        return mReady;
+      }
+      
+      void wait() {
+        // help running pool tasks rather than blocking a potential worker
+        while (!ready()) {
+          if (mPool && mPool->runPendingTask()) {
+            continue;
+          }
+          mAccess.lock();
+          while (!mReady) {
+            mReadyChanged.wait(mAccess);
+          }
+          mAccess.unlock();
+        }
+      }
+      
+      bool timedWait(unsigned long msec) {
+        // wake ups don't restart the timeout
+        double deadline = Thread::MonotonicTime() + 0.001 * double(msec);
+        ScopeLock lock(mAccess);
+        while (!mReady) {
+          double remaining = deadline - Thread::MonotonicTime();
+          if (remaining <= 0.0) {
+            break;
+          }
+          mReadyChanged.timedWait(mAccess, (unsigned long)(1000.0 * remaining) + 1);
+        }
+        return mReady;
+      }
+      
+      inline const R& value() const {
+        return mValue;
+      }
+      
+      inline ThreadPool* pool() const {
+        return mPool;
+      }
+      
+    private:
+      
+      FutureState(const FutureState&);
+      FutureState& operator=(const FutureState&);
+      
+    private:
+      
+      ThreadPool *mPool;
+      bool mReady;
+      R mValue;
+      Atomic<size_t> mRefCount;
+      std::vector<FutureCallback<R>*> mCallbacks;
+      Mutex mAccess;
+      Condition mReadyChanged;
+  };
+  
+  template <typename R>
+  class FutureTask {
+    public:
+      
+      FutureTask(Functor0wR<R> func, FutureState<R> *state)
+        : mFunc(func), mState(state) {
+        mState->ref();
+      }
+      
+      ~FutureTask() {
+        mState->unref();
+      }
+      
+      void run() {
+        mState->set(mFunc());
+        delete this;
+      }
+      
+    private:
+      
+      Functor0wR<R> mFunc;
+      FutureState<R> *mState;
+  };
+  
+  template <typename R, typename R2>
+  class FutureContinuation : public FutureCallback<R> {
+    public:
+      
+      FutureContinuation(FutureState<R> *src, Functor1wR<R2, R> func, FutureState<R2> *dst)
+        : mSrc(src), mFunc(func), mDst(dst) {
+        // mSrc isn't referenced: it owns this object until it is scheduled
+        mDst->ref();
+      }
+      
+      virtual ~FutureContinuation() {
+        mDst->unref();
+      }
+      
+      virtual void schedule() {
+        // keep the source value alive until the continuation has run
+        mSrc->ref();
+        Task task;
+        Bind(this, &FutureContinuation<R, R2>::run, task);
+        if (!mSrc->pool() || !mSrc->pool()->runTask(task)) {
+          run();
+        }
+      }
+      
+      void run() {
+        mDst->set(mFunc(mSrc->value()));
+        mSrc->unref();
+        delete this;
+      }
+      
+    private:
+      
+      FutureState<R> *mSrc;
+      Functor1wR<R2, R> mFunc;
+      FutureState<R2> *mDst;
+  };
+  
+  // Handle on the result of a ThreadPool::submit call
+  template <typename R>
+  class Future {
+    
+    public:
+      
+      Future()
+        : mState(0) {
+      }
+      
+      Future(FutureState<R> *state)
+        : mState(state) {
+      }
+      
+      Future(const Future<R> &rhs)
+        : mState(rhs.mState) {
+        if (mState) {
+          mState->ref();
+        }
+      }
+      
+      ~Future() {
+        if (mState) {
+          mState->unref();
+        }
+      }
+      
+      Future<R>& operator=(const Future<R> &rhs) {
+        if (rhs.mState) {
+          rhs.mState->ref();
+        }
+        if (mState) {
+          mState->unref();
+        }
+        mState = rhs.mState;
+        return *this;
+      }
+      
+      inline bool valid() const {
+        return (mState != 0);
+      }
+      
+      bool ready() const {
+        return (mState ? mState->ready() : false);
+      }
+      
+      // wait for the value, running pending pool tasks meanwhile
+      void wait() const {
+        if (mState) {
+          mState->wait();
+        }
+      }
+      
+      // returns true if the value is ready before msec milliseconds elapsed
+      bool timedWait(unsigned long msec) const {
+        return (mState ? mState->timedWait(msec) : false);
+      }
+      
+      // blocking, returns a default constructed value on an invalid future
+      R get() const {
+        if (!mState) {
+          return R();
+        }
+        mState->wait();
+        return mState->value();
+      }
+      
+      // non blocking, returns false if the value isn't ready yet
+      bool tryGet(R &val) const {
+        if (!mState || !mState->ready()) {
+          return false;
+        }
+        val = mState->value();
+        return true;
+      }
+      
+      // Run func with the value as a new pool task once it is ready.
+      // R2 cannot be void
+      template <typename R2>
+      Future<R2> then(Functor1wR<R2, R> func) const {
+        if (!mState) {
+          return Future<R2>();
+        }
+        FutureState<R2> *dst = new FutureState<R2>(mState->pool());
+        FutureContinuation<R, R2> *cont = new FutureContinuation<R, R2>(mState, func, dst);
+        if (!mState->addCallback(cont)) {
+          cont->schedule();
+        }
+        return Future<R2>(dst);
+      }
+      
+    private:
+      
+      FutureState<R> *mState;
+  };
+  
+  template <typename R>
+  Future<R> ThreadPool::submit(Functor0wR<R> func) {
+    FutureState<R> *state = new FutureState<R>(this);
+    FutureTask<R> *ft = new FutureTask<R>(func, state);
+    Task task;
+    Bind(ft, &FutureTask<R>::run, task);
+    if (!runTask(task)) {
+      delete ft;
+      state->unref();
+      return Future<R>();
+    }
+    return Future<R>(state);
+  }
+  
+  // Called with a [from, to) sub-range
+  typedef Functor2<size_t, size_t> RangeFunc;
+  
+  // Number of elements per task used by ParallelFor when grain is 0
+  GCORE_API size_t AutoGrainSize(ThreadPool &pool, size_t count);
+  
+  // Split [begin, end) in chunks of 'grain' elements run as pool tasks. The
+  // calling thread helps and returns once all chunks are processed. Chunks
+  // are run in the calling thread if the pool isn't running.
+  GCORE_API void ParallelFor(ThreadPool &pool, size_t begin, size_t end, size_t grain, RangeFunc func);
+  
+  template <class L>
+  class ParallelList {
+    
+    public:
+      
+      typedef typename L::value_type T;
+      
+      static void Filter(L &l, ThreadPool &pool, typename L::FilterFunc func, size_t grain) {
+        std::vector<char> keep(l.size(), 0);
+        FilterChunk chunk(l, keep, func);
+        RangeFunc rf;
+        Bind(&chunk, &FilterChunk::run, rf);
+        ParallelFor(pool, 0, l.size(), grain, rf);
+        // compact, keeping elements order
+        size_t j = 0;
+        for (size_t i=0; i<keep.size(); ++i) {
+          if (keep[i]) {
+            if (i != j) {
+              *(l.begin() + j) = *(l.begin() + i);
+            }
+            ++j;
+          }
+        }
+        l.erase(l.begin() + j, l.end());
+      }
+      
+      static void Map(L &l, ThreadPool &pool, typename L::MapFunc func, size_t grain) {
+        MapChunk chunk(l, func);
+        RangeFunc rf;
+        Bind(&chunk, &MapChunk::run, rf);
+        ParallelFor(pool, 0, l.size(), grain, rf);
+      }
+      
+      static T Reduce(const L &l, ThreadPool &pool, typename L::ReduceFunc func, const T &initVal, size_t grain) {
+        T val = initVal;
+        if (l.size() == 0) {
+          return val;
+        }
+        if (grain == 0) {
+          grain = AutoGrainSize(pool, l.size());
+        }
+        // one partial result per chunk, combined in order afterwards
+        std::vector<T> partials((l.size() + grain - 1) / grain);
+        ReduceChunk chunk(l, partials, func, grain);
+        RangeFunc rf;
+        Bind(&chunk, &ReduceChunk::run, rf);
+        ParallelFor(pool, 0, l.size(), grain, rf);
+        for (size_t i=0; i<partials.size(); ++i) {
+          val = func(val, partials[i]);
+        }
+        return val;
+      }
+    
+    private:
+      
+      class FilterChunk {
+        public:
+          FilterChunk(L &l, std::vector<char> &keep, typename L::FilterFunc func)
+            : mList(l), mKeep(keep), mFunc(func) {
+          }
+          void run(size_t from, size_t to) {
+            typename L::iterator it = mList.begin() + from;
+            for (size_t i=from; i<to; ++i, ++it) {
+              mKeep[i] = (mFunc(*it) ? 1 : 0);
+            }
+          }
+        private:
+          L &mList;
+          std::vector<char> &mKeep;
+          typename L::FilterFunc mFunc;
+      };
+      
+      class MapChunk {
+        public:
+          MapChunk(L &l, typename L::MapFunc func)
+            : mList(l), mFunc(func) {
+          }
+          void run(size_t from, size_t to) {
+            typename L::iterator it = mList.begin() + from;
+            for (size_t i=from; i<to; ++i, ++it) {
+              mFunc(*it);
+            }
+          }
+        private:
+          L &mList;
+          typename L::MapFunc mFunc;
+      };
+      
+      class ReduceChunk {
+        public:
+          ReduceChunk(const L &l, std::vector<T> &partials, typename L::ReduceFunc func, size_t grain)
+            : mList(l), mPartials(partials), mFunc(func), mGrain(grain) {
+          }
+          void run(size_t from, size_t to) {
+            typename L::const_iterator it = mList.begin() + from;
+            // start from the chunk first element, initVal may not be neutral
+            T val = *it;
+            ++it;
+            for (size_t i=from+1; i<to; ++i, ++it) {
+              val = mFunc(val, *it);
+            }
+            mPartials[from / mGrain] = val;
+          }
+        private:
+          const L &mList;
+          std::vector<T> &mPartials;
+          typename L::ReduceFunc mFunc;
+          size_t mGrain;
+      };
+  };
   
 }
 
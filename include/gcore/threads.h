@@ -28,6 +28,11 @@ SOFTWARE.
 #define __gcore_threads_h_
 
 #include <gcore/functor.h>
+#include <cstddef>
+#include <vector>
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
 
 namespace gcore {
 
@@ -36,7 +41,13 @@ namespace gcore {
       
       friend class Condition;
       
-      Mutex(bool recursive=false);
+      // spin count suitable for very short critical sections
+      static const unsigned int AdaptiveSpinCount;
+      
+      // spinCount > 0 enables adaptive mode: lock() first retries up to spinCount
+      // times (with a cpu pause in between) before blocking the thread
+      // [ignored on single processor machines where spinning only wastes time]
+      Mutex(bool recursive=false, unsigned int spinCount=0);
       virtual ~Mutex();
       
       void lock();
@@ -44,6 +55,10 @@ namespace gcore {
       void unlock();
       bool isLocked();
       
+      inline unsigned int spinCount() const {
+        return mSpinCount;
+      }
+      
     private:
       
       Mutex(const Mutex &){}
@@ -56,6 +71,8 @@ namespace gcore {
       //sizeof(CRITICAL_SECTION) == 24
       //sizeof(pthread_mutex_t)  == 44 (OSX)
       //round up to closest power of 2
+      
+      unsigned int mSpinCount;
   };
   
   // another kind of lock in pthread: rwlock !
@@ -132,6 +149,37 @@ namespace gcore {
       //long mMax;
       unsigned char mData[128];
   };
+  
+  // Event threads can wait on until it is set
+  // - manual reset: stays set (releasing all current and future waiters)
+  //   until reset() is called
+  // - auto reset: set() releases a single waiter and the event goes back
+  //   to unset state
+  // Uses futexes on Linux (no system call when nobody is waiting), native
+  // events on Windows and a mutex/condition pair elsewhere.
+  class GCORE_API SyncEvent {
+    public:
+      
+      SyncEvent(bool autoReset=false, bool initialState=false);
+      virtual ~SyncEvent();
+      
+      void set();
+      void reset();
+      bool isSet() const;
+      
+      void wait();
+      bool timedWait(unsigned long msec);
+      
+    private:
+      
+      SyncEvent(const SyncEvent &);
+      SyncEvent& operator=(const SyncEvent &);
+      
+    private:
+      
+      unsigned char mData[128];
+      bool mAutoReset;
+  };
 
 
   class GCORE_API ScopeLock {
@@ -195,6 +243,9 @@ namespace gcore {
       typedef Functor0wR<int> Procedure;
       typedef Functor1<int> EndCallback;
       
+      // list of logical processor indices
+      typedef std::vector<unsigned int> CPUSet;
+      
       Thread();
       
       Thread(Procedure proc, EndCallback ended=EndCallback(), bool waitStart=false);
@@ -266,6 +317,9 @@ namespace gcore {
       // scheduling
       Scheduling scheduling() const;
       bool scheduling(Scheduling s);
+      // processors this thread may run on [empty if unknown or unsupported]
+      CPUSet affinity() const;
+      bool affinity(const CPUSet &cpus);
       // this thread id
       ThreadID id() const;
       // suspend curreny thread
@@ -277,10 +331,18 @@ namespace gcore {
       static void SleepCurrent(unsigned long msec);
       // yield current thread time quantum
       static void YieldCurrent();
+      // monotonic time in seconds [for timeouts and durations]
+      static double MonotonicTime();
       // get current thread id
       static ThreadID CurrentID();
       // get number of processor on machine
       static int GetProcessorCount();
+      // restrict current thread to the given processors
+      static bool PinCurrent(const CPUSet &cpus);
+      // get number of NUMA nodes on machine [1 if not a NUMA system]
+      static int GetNodeCount();
+      // get processors belonging to a NUMA node
+      static CPUSet GetNodeProcessors(int node);
       
     private:
       
@@ -309,6 +371,904 @@ namespace gcore {
       Mutex mMutex;
       bool mStarted;
   };
+  
+  // Per-thread values for ThreadLocal<T> (native TLS key)
+  // - values are registered so that they can be enumerated from any thread
+  // - a thread's value is destroyed when the thread exits
+  class GCORE_API ThreadLocalBase {
+    public:
+      
+      ThreadLocalBase();
+      virtual ~ThreadLocalBase();
+      
+      // number of threads with a value
+      size_t count() const;
+      
+      // native TLS destructor, not meant to be called directly
+      static void ThreadExit(void *data);
+      
+    protected:
+      
+      struct Slot {
+        ThreadLocalBase *owner;
+        Slot *prev;
+        Slot *next;
+      };
+      
+      // calling thread slot, 0 if none yet
+      Slot* slot() const;
+      // make s the calling thread slot
+      void attach(Slot *s);
+      // free native key and destroy all remaining values
+      // [must be called from the derived class destructor]
+      void cleanup();
+      
+      virtual void destroySlot(Slot *s) = 0;
+      
+      // unregister and destroy s
+      void release(Slot *s);
+      
+    private:
+      
+      ThreadLocalBase(const ThreadLocalBase&);
+      ThreadLocalBase& operator=(const ThreadLocalBase&);
+      
+    protected:
+      
+      mutable Mutex mSlotsAccess;
+      Slot *mSlots;
+      bool mValid;
+      unsigned char mKey[16];
+  };
+  
+  // Thread local value
+  // - a thread's value is copy constructed from the initial value on first access
+  // - each() enumerates the values of all the threads that accessed it and are
+  //   still alive, returning false from the callback stops the enumeration
+  //   [values are accessed while their thread may still be using them]
+  template <typename T>
+  class ThreadLocal : public ThreadLocalBase {
+    public:
+      
+      typedef Functor1wR<bool, T&> EachFunc;
+      
+      ThreadLocal(const T &initVal=T())
+        : ThreadLocalBase(), mInitVal(initVal) {
+      }
+      
+      virtual ~ThreadLocal() {
+        cleanup();
+      }
+      
+      T& get() {
+        Value *v = (Value*) slot();
+        if (!v) {
+          v = new Value(this, mInitVal);
+          attach(v);
+        }
+        return v->value;
+      }
+      
+      inline T& operator*() {
+        return get();
+      }
+      
+      inline T* operator->() {
+        return &(get());
+      }
+      
+      void each(EachFunc cb) {
+        ScopeLock lock(mSlotsAccess);
+        for (Slot *s=mSlots; s!=0; s=s->next) {
+          if (!cb(((Value*)s)->value)) {
+            break;
+          }
+        }
+      }
+      
+    protected:
+      
+      struct Value : public Slot {
+        Value(ThreadLocalBase *o, const T &v)
+          : value(v) {
+          owner = o;
+          prev = 0;
+          next = 0;
+        }
+        T value;
+      };
+      
+      virtual void destroySlot(Slot *s) {
+        delete (Value*)s;
+      }
+      
+    private:
+      
+      T mInitVal;
+  };
+  
+  // Memory ordering constraints for atomic operations
+  //   MO_RELAXED: atomicity only, no ordering with other memory accesses
+  //   MO_ACQUIRE: no later read/write can be moved before the operation (loads)
+  //   MO_RELEASE: no earlier read/write can be moved after the operation (stores)
+  //   MO_ACQ_REL: both of the above (read-modify-write operations)
+  //   MO_SEQ_CST: acquire/release plus a single total order for all such operations
+  enum MemoryOrder {
+    MO_RELAXED = 0,
+    MO_ACQUIRE,
+    MO_RELEASE,
+    MO_ACQ_REL,
+    MO_SEQ_CST
+  };
+  
+  namespace internal {
+    
+#ifdef _MSC_VER
+    
+    // Only x86/x64 targets are supported: plain volatile accesses already
+    // have acquire/release semantics there, interlocked functions are full barriers
+    
+    template <int Size> struct Interlocked {};
+    
+    template <> struct Interlocked<1> {
+      typedef char Word;
+      static inline Word CompareExchange(volatile Word *p, Word desired, Word expected) {
+        return _InterlockedCompareExchange8(p, desired, expected);
+      }
+      static inline Word Exchange(volatile Word *p, Word val) {
+        return _InterlockedExchange8(p, val);
+      }
+      static inline Word ExchangeAdd(volatile Word *p, Word val) {
+        return _InterlockedExchangeAdd8(p, val);
+      }
+    };
+    
+    template <> struct Interlocked<2> {
+      typedef short Word;
+      static inline Word CompareExchange(volatile Word *p, Word desired, Word expected) {
+        return _InterlockedCompareExchange16(p, desired, expected);
+      }
+      static inline Word Exchange(volatile Word *p, Word val) {
+        return _InterlockedExchange16(p, val);
+      }
+      static inline Word ExchangeAdd(volatile Word *p, Word val) {
+        return _InterlockedExchangeAdd16(p, val);
+      }
+    };
+    
+    template <> struct Interlocked<4> {
+      typedef long Word;
+      static inline Word CompareExchange(volatile Word *p, Word desired, Word expected) {
+        return _InterlockedCompareExchange(p, desired, expected);
+      }
+      static inline Word Exchange(volatile Word *p, Word val) {
+        return _InterlockedExchange(p, val);
+      }
+      static inline Word ExchangeAdd(volatile Word *p, Word val) {
+        return _InterlockedExchangeAdd(p, val);
+      }
+    };
+    
+    template <> struct Interlocked<8> {
+      typedef __int64 Word;
+      static inline Word CompareExchange(volatile Word *p, Word desired, Word expected) {
+        return _InterlockedCompareExchange64(p, desired, expected);
+      }
+      static inline Word Exchange(volatile Word *p, Word val) {
+        return _InterlockedExchange64(p, val);
+      }
+      static inline Word ExchangeAdd(volatile Word *p, Word val) {
+        return _InterlockedExchangeAdd64(p, val);
+      }
+    };
+    
+    template <typename T>
+    struct AtomicOps {
+      
+      typedef Interlocked<sizeof(T)> Impl;
+      typedef typename Impl::Word Word;
+      
+      union Value {
+        T t;
+        Word w;
+      };
+      
+      static inline Word ToWord(T val) {
+        Value v;
+        v.t = val;
+        return v.w;
+      }
+      
+      static inline T FromWord(Word val) {
+        Value v;
+        v.w = val;
+        return v.t;
+      }
+      
+      static inline T Load(const volatile T *p, MemoryOrder) {
+        T val = *p;
+        _ReadWriteBarrier();
+        return val;
+      }
+      
+      static inline void Store(volatile T *p, T val, MemoryOrder order) {
+        if (order == MO_SEQ_CST) {
+          Impl::Exchange((volatile Word*)p, ToWord(val));
+        } else {
+          _ReadWriteBarrier();
+          *p = val;
+        }
+      }
+      
+      static inline T Exchange(volatile T *p, T val, MemoryOrder) {
+        return FromWord(Impl::Exchange((volatile Word*)p, ToWord(val)));
+      }
+      
+      static inline bool CompareExchange(volatile T *p, T &expected, T desired, MemoryOrder) {
+        Word e = ToWord(expected);
+        Word cur = Impl::CompareExchange((volatile Word*)p, ToWord(desired), e);
+        if (cur == e) {
+          return true;
+        }
+        expected = FromWord(cur);
+        return false;
+      }
+      
+      template <typename D>
+      static inline T FetchAdd(volatile T *p, D val, MemoryOrder) {
+        return FromWord(Impl::ExchangeAdd((volatile Word*)p, (Word)val));
+      }
+    };
+    
+    inline void Fence(MemoryOrder order) {
+      if (order == MO_SEQ_CST) {
+        volatile long dummy = 0;
+        _InterlockedOr(&dummy, 0);
+      } else if (order != MO_RELAXED) {
+        _ReadWriteBarrier();
+      }
+    }
+    
+#else
+    
+    inline int Order(MemoryOrder order) {
+      switch (order) {
+        case MO_RELAXED: return __ATOMIC_RELAXED;
+        case MO_ACQUIRE: return __ATOMIC_ACQUIRE;
+        case MO_RELEASE: return __ATOMIC_RELEASE;
+        case MO_ACQ_REL: return __ATOMIC_ACQ_REL;
+        default: return __ATOMIC_SEQ_CST;
+      }
+    }
+    
+    // loads cannot release, stores cannot acquire: use the closest valid order
+    
+    inline int LoadOrder(MemoryOrder order) {
+      return (order == MO_RELEASE || order == MO_ACQ_REL ? __ATOMIC_ACQUIRE : Order(order));
+    }
+    
+    inline int StoreOrder(MemoryOrder order) {
+      return (order == MO_ACQUIRE || order == MO_ACQ_REL ? __ATOMIC_RELEASE : Order(order));
+    }
+    
+    inline int FailureOrder(MemoryOrder order) {
+      return (order == MO_RELEASE ? __ATOMIC_RELAXED : LoadOrder(order));
+    }
+    
+    template <typename T>
+    struct AtomicOps {
+      
+      static inline T Load(const volatile T *p, MemoryOrder order) {
+        return __atomic_load_n(p, LoadOrder(order));
+      }
+      
+      static inline void Store(volatile T *p, T val, MemoryOrder order) {
+        __atomic_store_n(p, val, StoreOrder(order));
+      }
+      
+      static inline T Exchange(volatile T *p, T val, MemoryOrder order) {
+        return __atomic_exchange_n(p, val, Order(order));
+      }
+      
+      static inline bool CompareExchange(volatile T *p, T &expected, T desired, MemoryOrder order) {
+        return __atomic_compare_exchange_n(p, &expected, desired, false, Order(order), FailureOrder(order));
+      }
+      
+      // for pointers, val is a number of bytes
+      template <typename D>
+      static inline T FetchAdd(volatile T *p, D val, MemoryOrder order) {
+        return __atomic_fetch_add(p, val, Order(order));
+      }
+    };
+    
+    inline void Fence(MemoryOrder order) {
+      __atomic_thread_fence(Order(order));
+    }
+    
+#endif
+    
+    // Type of the increment for fetchAdd/fetchSub, pointers move by whole elements
+    
+    // [Scale is a function so that pointers to incomplete types can be used]
+    
+    template <typename T> struct AtomicDiff {
+      typedef T Type;
+      static inline Type Scale() { return Type(1); }
+    };
+    
+    template <typename T> struct AtomicDiff<T*> {
+      typedef ptrdiff_t Type;
+      static inline Type Scale() { return Type(sizeof(T)); }
+    };
+    
+    template <> struct AtomicDiff<void*> {
+      typedef ptrdiff_t Type;
+      static inline Type Scale() { return Type(1); }
+    };
+    
+    // Keep independently updated fields on separate cache lines
+    enum {
+      CacheLineSize = 64
+    };
+    
+    // Hint the processor that we are in a spin-wait loop
+    inline void CpuPause() {
+#if defined(_MSC_VER)
+#  if defined(_M_IX86) || defined(_M_X64)
+      _mm_pause();
+#  else
+      __yield();
+#  endif
+#elif defined(__i386__) || defined(__x86_64__)
+      __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+      __asm__ __volatile__ ("yield" ::: "memory");
+#else
+      __asm__ __volatile__ ("" ::: "memory");
+#endif
+    }
+  }
+  
+  // Issue a memory fence with the given ordering
+  inline void MemoryFence(MemoryOrder order=MO_SEQ_CST) {
+    internal::Fence(order);
+  }
+  
+  // Integral (1, 2, 4 or 8 bytes) or pointer value with atomic access
+  // - every operation takes an optional memory order (sequentially consistent
+  //   by default, as are the conversion and arithmetic operators)
+  // - fetchAdd/fetchSub return the previous value, ++/--/+=/-= the new one
+  // - initialization (constructor) is not atomic
+  template <typename T>
+  class Atomic {
+    public:
+      
+      typedef typename internal::AtomicDiff<T>::Type Diff;
+      
+      inline Atomic()
+        : mValue(T()) {
+      }
+      
+      inline Atomic(T val)
+        : mValue(val) {
+      }
+      
+      inline T load(MemoryOrder order=MO_SEQ_CST) const {
+        return internal::AtomicOps<T>::Load(&mValue, order);
+      }
+      
+      inline void store(T val, MemoryOrder order=MO_SEQ_CST) {
+        internal::AtomicOps<T>::Store(&mValue, val, order);
+      }
+      
+      inline T exchange(T val, MemoryOrder order=MO_SEQ_CST) {
+        return internal::AtomicOps<T>::Exchange(&mValue, val, order);
+      }
+      
+      // if current value is expected, replace it by desired and return true
+      // otherwise, expected is set to the current value and false is returned
+      inline bool compareExchange(T &expected, T desired, MemoryOrder order=MO_SEQ_CST) {
+        return internal::AtomicOps<T>::CompareExchange(&mValue, expected, desired, order);
+      }
+      
+      inline T fetchAdd(Diff val, MemoryOrder order=MO_SEQ_CST) {
+        return internal::AtomicOps<T>::FetchAdd(&mValue, val * internal::AtomicDiff<T>::Scale(), order);
+      }
+      
+      inline T fetchSub(Diff val, MemoryOrder order=MO_SEQ_CST) {
+        return internal::AtomicOps<T>::FetchAdd(&mValue, Diff(0) - val * internal::AtomicDiff<T>::Scale(), order);
+      }
+      
+      inline operator T () const {
+        return load();
+      }
+      
+      inline Atomic<T>& operator=(T val) {
+        store(val);
+        return *this;
+      }
+      
+      inline T operator++() {
+        return fetchAdd(1) + 1;
+      }
+      
+      inline T operator++(int) {
+        return fetchAdd(1);
+      }
+      
+      inline T operator--() {
+        return fetchSub(1) - 1;
+      }
+      
+      inline T operator--(int) {
+        return fetchSub(1);
+      }
+      
+      inline T operator+=(Diff val) {
+        return fetchAdd(val) + val;
+      }
+      
+      inline T operator-=(Diff val) {
+        return fetchSub(val) - val;
+      }
+      
+    private:
+      
+      Atomic(const Atomic<T>&);
+      Atomic<T>& operator=(const Atomic<T>&);
+      
+    private:
+      
+      volatile T mValue;
+  };
+  
+  // Bounded lock-free multi-producer/multi-consumer FIFO queue
+  //   based on a ring buffer where each slot carries a sequence number
+  //   telling producers and consumers whether it is their turn to use it
+  //   (D. Vyukov's algorithm)
+  // - capacity is rounded up to the next power of 2
+  // - push returns false when the queue is full, pop when it is empty
+  //   [neither ever blocks, it is up to the caller to retry, yield or sleep]
+  // - T must be default constructible and assignable
+  //   [a popped slot is reset to T() so that it does not keep resources alive]
+  template <typename T>
+  class MPMCQueue {
+    public:
+      
+      MPMCQueue(size_t capacity)
+        : mCells(0), mMask(0), mPushPos(0), mPopPos(0) {
+        size_t n = 2;
+        while (n < capacity) {
+          n <<= 1;
+        }
+        mMask = n - 1;
+        mCells = new Cell[n];
+        for (size_t i=0; i<n; ++i) {
+          mCells[i].seq.store(i, MO_RELAXED);
+        }
+      }
+      
+      ~MPMCQueue() {
+        delete[] mCells;
+      }
+      
+      bool push(const T &val) {
+        Cell *cell = 0;
+        size_t pos = mPushPos.load(MO_RELAXED);
+        for (;;) {
+          cell = &(mCells[pos & mMask]);
+          ptrdiff_t dif = (ptrdiff_t)(cell->seq.load(MO_ACQUIRE) - pos);
+          if (dif == 0) {
+            // slot is free for this round, try to claim it
+            // [on failure, pos is updated with the current push position]
+            if (mPushPos.compareExchange(pos, pos + 1, MO_RELAXED)) {
+              break;
+            }
+          } else if (dif < 0) {
+            // slot still holds the value pushed one round earlier
+            return false;
+          } else {
+            // another producer got it first
+            pos = mPushPos.load(MO_RELAXED);
+          }
+        }
+        cell->value = val;
+        cell->seq.store(pos + 1, MO_RELEASE);
+        return true;
+      }
+      
+      bool pop(T &val) {
+        Cell *cell = 0;
+        size_t pos = mPopPos.load(MO_RELAXED);
+        for (;;) {
+          cell = &(mCells[pos & mMask]);
+          ptrdiff_t dif = (ptrdiff_t)(cell->seq.load(MO_ACQUIRE) - (pos + 1));
+          if (dif == 0) {
+            if (mPopPos.compareExchange(pos, pos + 1, MO_RELAXED)) {
+              break;
+            }
+          } else if (dif < 0) {
+            // not yet pushed
+            return false;
+          } else {
+            pos = mPopPos.load(MO_RELAXED);
+          }
+        }
+        val = cell->value;
+        cell->value = T();
+        cell->seq.store(pos + mMask + 1, MO_RELEASE);
+        return true;
+      }
+      
+      inline size_t capacity() const {
+        return (mMask + 1);
+      }
+      
+      // only a hint when other threads are pushing or popping
+      size_t size() const {
+        size_t popPos = mPopPos.load(MO_ACQUIRE);
+        size_t pushPos = mPushPos.load(MO_ACQUIRE);
+        return (pushPos > popPos ? pushPos - popPos : 0);
+      }
+      
+      inline bool empty() const {
+        return (size() == 0);
+      }
+      
+    private:
+      
+      MPMCQueue(const MPMCQueue&);
+      MPMCQueue& operator=(const MPMCQueue&);
+      
+      struct Cell {
+        Atomic<size_t> seq;
+        T value;
+      };
+      
+      Cell *mCells;
+      size_t mMask;
+      char mPad0[internal::CacheLineSize];
+      Atomic<size_t> mPushPos;
+      char mPad1[internal::CacheLineSize - sizeof(size_t)];
+      Atomic<size_t> mPopPos;
+      char mPad2[internal::CacheLineSize - sizeof(size_t)];
+  };
+  
+  // Unbounded lock-free single-producer/single-consumer FIFO queue
+  //   linked list of nodes, consumed nodes are recycled by the producer
+  //   so that allocation only happens when the queue grows
+  // - push must always be called from the same thread, pop from another one
+  // - T must be default constructible and assignable
+  template <typename T>
+  class SPSCQueue {
+    public:
+      
+      SPSCQueue()
+        : mHead(0), mFirst(0), mTailCopy(0), mTail(0) {
+        Node *n = new Node();
+        mHead = n;
+        mFirst = n;
+        mTailCopy = n;
+        mTail.store(n, MO_RELAXED);
+      }
+      
+      ~SPSCQueue() {
+        Node *n = mFirst;
+        while (n) {
+          Node *next = n->next.load(MO_RELAXED);
+          delete n;
+          n = next;
+        }
+      }
+      
+      // producer side
+      void push(const T &val) {
+        Node *n = allocNode();
+        n->value = val;
+        n->next.store(0, MO_RELAXED);
+        mHead->next.store(n, MO_RELEASE);
+        mHead = n;
+      }
+      
+      // consumer side
+      bool pop(T &val) {
+        Node *n = mTail.load(MO_RELAXED)->next.load(MO_ACQUIRE);
+        if (!n) {
+          return false;
+        }
+        val = n->value;
+        n->value = T();
+        // n becomes the new dummy node, previous one can be recycled
+        mTail.store(n, MO_RELEASE);
+        return true;
+      }
+      
+      // consumer side
+      bool empty() const {
+        return (mTail.load(MO_RELAXED)->next.load(MO_ACQUIRE) == 0);
+      }
+      
+    private:
+      
+      SPSCQueue(const SPSCQueue&);
+      SPSCQueue& operator=(const SPSCQueue&);
+      
+      struct Node {
+        Atomic<Node*> next;
+        T value;
+      };
+      
+      Node* allocNode() {
+        // nodes from mFirst up to (not including) mTail were consumed
+        if (mFirst == mTailCopy) {
+          mTailCopy = mTail.load(MO_ACQUIRE);
+          if (mFirst == mTailCopy) {
+            return new Node();
+          }
+        }
+        Node *n = mFirst;
+        mFirst = mFirst->next.load(MO_RELAXED);
+        return n;
+      }
+      
+      // producer
+      Node *mHead;
+      Node *mFirst;
+      Node *mTailCopy;
+      char mPad0[internal::CacheLineSize];
+      // consumer
+      Atomic<Node*> mTail;
+      char mPad1[internal::CacheLineSize - sizeof(Node*)];
+  };
+  
+  // Sequence lock for small, rarely written data
+  //   writers make the sequence odd for the duration of their update, readers
+  //   copy the data without writing to shared memory and retry if the sequence
+  //   was odd or changed in the meantime
+  // - readers never block writers, writers are serialized on the sequence
+  // - a reader may copy a torn value that it then discards, the data must be
+  //   plain (trivially copyable) and only be used once readRetry returned false
+  // - not recursive
+  //
+  //   size_t seq;
+  //   do {
+  //     seq = lock.readBegin();
+  //     copy = data;
+  //   } while (lock.readRetry(seq));
+  class SeqLock {
+    public:
+      
+      SeqLock()
+        : mSeq(0) {
+      }
+      
+      inline size_t readBegin() const {
+        unsigned int spins = 0;
+        size_t seq = mSeq.load(MO_ACQUIRE);
+        while (seq & 1) {
+          Backoff(spins);
+          seq = mSeq.load(MO_ACQUIRE);
+        }
+        return seq;
+      }
+      
+      // true if the data read since readBegin must be read again
+      inline bool readRetry(size_t seq) const {
+        // data reads cannot be moved after the sequence check
+        MemoryFence(MO_ACQUIRE);
+        return (mSeq.load(MO_RELAXED) != seq);
+      }
+      
+      inline void writeLock() {
+        unsigned int spins = 0;
+        while (!tryWriteLock()) {
+          Backoff(spins);
+        }
+      }
+      
+      inline bool tryWriteLock() {
+        size_t seq = mSeq.load(MO_RELAXED);
+        if ((seq & 1) != 0 || !mSeq.compareExchange(seq, seq + 1, MO_ACQUIRE)) {
+          return false;
+        }
+        // data writes cannot be moved before the sequence update
+        MemoryFence(MO_RELEASE);
+        return true;
+      }
+      
+      inline void writeUnlock() {
+        mSeq.store(mSeq.load(MO_RELAXED) + 1, MO_RELEASE);
+      }
+      
+      // number of completed writes
+      inline size_t writes() const {
+        return (mSeq.load(MO_ACQUIRE) >> 1);
+      }
+      
+    private:
+      
+      SeqLock(const SeqLock&);
+      SeqLock& operator=(const SeqLock&);
+      
+      static inline void Backoff(unsigned int &spins) {
+        // a preempted writer won't make progress while we spin
+        if (++spins < 64) {
+          internal::CpuPause();
+        } else {
+          Thread::YieldCurrent();
+        }
+      }
+      
+      Atomic<size_t> mSeq;
+  };
+  
+  // Value protected by a SeqLock
+  // - T must be default constructible and trivially copyable
+  template <typename T>
+  class SeqLocked {
+    public:
+      
+      SeqLocked()
+        : mValue() {
+      }
+      
+      SeqLocked(const T &val)
+        : mValue(val) {
+      }
+      
+      T read() const {
+        T val;
+        size_t seq;
+        do {
+          seq = mLock.readBegin();
+          val = mValue;
+        } while (mLock.readRetry(seq));
+        return val;
+      }
+      
+      void write(const T &val) {
+        mLock.writeLock();
+        mValue = val;
+        mLock.writeUnlock();
+      }
+      
+      inline const SeqLock& lock() const {
+        return mLock;
+      }
+      
+    private:
+      
+      SeqLocked(const SeqLocked&);
+      SeqLocked& operator=(const SeqLocked&);
+      
+      SeqLock mLock;
+      T mValue;
+  };
+  
+  // Reader/writer lock with per-processor reader counters
+  //   readers only touch the counter of the processor they run on so that read
+  //   mostly workloads do not bounce a shared cache line between cores, writers
+  //   raise a flag and wait for all the counters to drain
+  // - readLock returns the slot to pass back to readUnlock
+  //   [the thread may have migrated to another processor in between]
+  // - writers have priority, new readers block until the pending write is done
+  // - numSlots defaults to the processor count (rounded up to a power of 2)
+  // - not recursive
+  class GCORE_API DistributedRWLock {
+    public:
+      
+      DistributedRWLock(size_t numSlots=0);
+      virtual ~DistributedRWLock();
+      
+      size_t readLock();
+      bool tryReadLock(size_t &slot);
+      void readUnlock(size_t slot);
+      
+      void writeLock();
+      bool tryWriteLock();
+      void writeUnlock();
+      
+      inline size_t numSlots() const {
+        return (mMask + 1);
+      }
+      
+    private:
+      
+      DistributedRWLock(const DistributedRWLock&);
+      DistributedRWLock& operator=(const DistributedRWLock&);
+      
+      size_t currentSlot() const;
+      bool drained() const;
+      
+      struct Slot {
+        Atomic<long> readers;
+        char pad[internal::CacheLineSize - sizeof(long)];
+      };
+      
+      Slot *mSlots;
+      size_t mMask;
+      char mPad0[internal::CacheLineSize];
+      Atomic<int> mWriter;
+      char mPad1[internal::CacheLineSize - sizeof(int)];
+      Mutex mWriteAccess;
+  };
+  
+  // Single use countdown: wait() returns once count arrivals were signaled
+  // - waiters spin up to spinCount times before blocking [as Mutex]
+  // - the latch must outlive the countDown calls, not only the waits
+  class GCORE_API Latch {
+    public:
+      
+      // spin count suitable for phases of a few microseconds
+      static const unsigned int DefaultSpinCount;
+      
+      Latch(size_t count, unsigned int spinCount=DefaultSpinCount);
+      virtual ~Latch();
+      
+      void countDown(size_t n=1);
+      // countDown followed by wait
+      void arriveAndWait(size_t n=1);
+      
+      // true if the count reached zero
+      bool tryWait() const;
+      void wait();
+      bool timedWait(unsigned long msec);
+      
+      inline size_t count() const {
+        return mCount.load(MO_ACQUIRE);
+      }
+      
+    private:
+      
+      Latch(const Latch&);
+      Latch& operator=(const Latch&);
+      
+      bool spin() const;
+      
+      Atomic<size_t> mCount;
+      unsigned int mSpinCount;
+      Mutex mMutex;
+      Condition mReleased;
+  };
+  
+  // Reusable rendez-vous point for a fixed number of threads
+  // - wait() blocks until count threads called it, then releases them all and
+  //   resets for the next phase. It returns true in exactly one thread per
+  //   phase (the last one to arrive)
+  // - waiters spin up to spinCount times before blocking [as Mutex]
+  class GCORE_API Barrier {
+    public:
+      
+      static const unsigned int DefaultSpinCount;
+      
+      Barrier(size_t count, unsigned int spinCount=DefaultSpinCount);
+      virtual ~Barrier();
+      
+      bool wait();
+      
+      inline size_t count() const {
+        return mCount;
+      }
+      
+      // number of completed phases
+      inline size_t phase() const {
+        return mPhase.load(MO_ACQUIRE);
+      }
+      
+    private:
+      
+      Barrier(const Barrier&);
+      Barrier& operator=(const Barrier&);
+      
+      size_t mCount;
+      unsigned int mSpinCount;
+      Atomic<size_t> mRemaining;
+      char mPad0[internal::CacheLineSize - sizeof(size_t)];
+      Atomic<size_t> mPhase;
+      char mPad1[internal::CacheLineSize - sizeof(size_t)];
+      Mutex mMutex;
+      Condition mReleased;
+  };
 }
 
 
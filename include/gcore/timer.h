@@ -0,0 +1,156 @@
+/*
+MIT License
+
+Copyright (c) 2009 Gaetan Guidet
+
+This file is part of gcore.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#ifndef __gcore_timer_h_
+#define __gcore_timer_h_
+
+#include <gcore/threads.h>
+
+namespace gcore {
+  
+  class ThreadPool;
+  class EventQueue;
+  
+  // 0 is never a valid timer
+  typedef UInt64 TimerID;
+  
+  // Hierarchical timer wheel: callbacks scheduled after a delay or periodically,
+  // with constant time schedule and cancel whatever the number of pending
+  // timers. A single thread advances the wheel every 'resolution' milliseconds
+  // (only while timers are pending) and dispatches due callbacks, either
+  // running them straight away or handing them to a ThreadPool or EventQueue.
+  // Callbacks run in the timer thread must be short not to delay the others.
+  class GCORE_API TimerWheel {
+    
+    public:
+      
+      TimerWheel();
+      
+      // stops the timer thread
+      ~TimerWheel();
+      
+      bool start(unsigned long resolution=1);
+      
+      // cancels all pending timers. May be called from a timer callback, the
+      // thread then exits once the callback returns
+      bool stop();
+      
+      bool running();
+      
+      // Run func after delay milliseconds (never earlier, up to one resolution
+      // later), then every period milliseconds if period isn't 0.
+      // Returns 0 if the wheel isn't running
+      TimerID schedule(Functor0 func, unsigned long delay, unsigned long period=0);
+      
+      // same, func is queued as a task of pool when due [dropped if the pool is
+      // stopped]. Periodic runs may overlap if func lasts longer than period
+      TimerID schedule(Functor0 func, ThreadPool &pool, unsigned long delay, unsigned long period=0);
+      
+      // same, func is pushed (asynchronously) to queue when due
+      TimerID schedule(Functor0 func, EventQueue &queue, unsigned long delay, unsigned long period=0);
+      
+      // Returns false if the timer already fired (one shot) or was cancelled.
+      // A callback already handed to a pool or queue isn't recalled
+      bool cancel(TimerID id);
+      
+      size_t numPending();
+      
+      inline unsigned long resolution() const {
+        return mResolution;
+      }
+    
+    private:
+      
+      enum {
+        LevelBits = 8,
+        NumLevels = 4,
+        NumSlots = 1 << LevelBits,
+        SlotMask = NumSlots - 1
+      };
+      
+      static const size_t NoTimer;
+      
+      struct Timer {
+        Functor0 func;
+        ThreadPool *pool;
+        EventQueue *queue;
+        // in ticks
+        UInt64 expires;
+        UInt64 period;
+        // slot list links, or free list link
+        size_t prev;
+        size_t next;
+        size_t *head;
+        // bumped on release so that stale ids are rejected
+        unsigned int generation;
+        bool active;
+      };
+      
+      struct Due {
+        Functor0 func;
+        ThreadPool *pool;
+        EventQueue *queue;
+      };
+      
+      TimerWheel(const TimerWheel&);
+      TimerWheel& operator=(const TimerWheel&);
+      
+      TimerID add(Functor0 func, ThreadPool *pool, EventQueue *queue, unsigned long delay, unsigned long period);
+      
+      // wheel tick matching the current time
+      UInt64 currentTick() const;
+      
+      // all following functions must be called with mAccess locked
+      // wait for the timer thread to exit [not from the timer thread]
+      void deleteThread();
+      void insert(size_t index);
+      void unlink(size_t index);
+      void release(size_t index);
+      void cascade(size_t level, size_t slot);
+      // move the wheel one tick forward, collecting due timers
+      void advance(std::vector<Due> &due);
+      
+      int run();
+      void done(int);
+      
+    private:
+      
+      std::vector<Timer> mTimers;
+      size_t mFree;
+      size_t mSlots[NumLevels][NumSlots];
+      size_t mCount;
+      UInt64 mCurrent;
+      double mStart;
+      unsigned long mResolution;
+      bool mRunning;
+      bool mThreadRunning;
+      Thread *mThread;
+      Mutex mAccess;
+      Condition mChanged;
+  };
+}
+
+#endif
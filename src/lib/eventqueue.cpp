@@ -29,9 +29,129 @@ SOFTWARE.
 namespace gcore
 {
 
-EventQueue::EventQueue()
-  : mOwner(Thread::CurrentID()), mAcceptEvents(true), mDoneID((size_t)-1), mCurID(0)
+struct EventQueue::Handle::Slot
 {
+  Mutex mutex;
+  Condition cond;
+  Atomic<bool> done;
+  Atomic<int> refs;
+  
+  Slot()
+    : done(false), refs(1)
+  {
+  }
+};
+
+EventQueue::Handle::Handle()
+  : mSlot(0)
+{
+}
+
+EventQueue::Handle::Handle(const Handle &rhs)
+  : mSlot(rhs.mSlot)
+{
+  if (mSlot)
+  {
+    ++(mSlot->refs);
+  }
+}
+
+EventQueue::Handle::~Handle()
+{
+  reset(false);
+}
+
+EventQueue::Handle& EventQueue::Handle::operator=(const Handle &rhs)
+{
+  if (this != &rhs && mSlot != rhs.mSlot)
+  {
+    reset(false);
+    mSlot = rhs.mSlot;
+    if (mSlot)
+    {
+      ++(mSlot->refs);
+    }
+  }
+  return *this;
+}
+
+void EventQueue::Handle::reset(bool attach)
+{
+  if (mSlot && --(mSlot->refs) == 0)
+  {
+    delete mSlot;
+  }
+  mSlot = (attach ? new Slot() : 0);
+}
+
+bool EventQueue::Handle::valid() const
+{
+  return (mSlot != 0);
+}
+
+bool EventQueue::Handle::done() const
+{
+  return (mSlot != 0 && mSlot->done.load(MO_ACQUIRE));
+}
+
+void EventQueue::Handle::signal()
+{
+  mSlot->mutex.lock();
+  mSlot->done.store(true, MO_RELEASE);
+  mSlot->cond.notifyAll();
+  mSlot->mutex.unlock();
+}
+
+void EventQueue::Handle::wait()
+{
+  if (!mSlot || mSlot->done.load(MO_ACQUIRE))
+  {
+    return;
+  }
+  mSlot->mutex.lock();
+  while (!mSlot->done.load(MO_ACQUIRE))
+  {
+    mSlot->cond.wait(mSlot->mutex);
+  }
+  mSlot->mutex.unlock();
+}
+
+bool EventQueue::Handle::wait(unsigned long msec)
+{
+  if (!mSlot)
+  {
+    return false;
+  }
+  if (mSlot->done.load(MO_ACQUIRE))
+  {
+    return true;
+  }
+  
+  // wake ups don't restart the timeout
+  double deadline = Thread::MonotonicTime() + 0.001 * double(msec);
+  
+  mSlot->mutex.lock();
+  while (!mSlot->done.load(MO_ACQUIRE))
+  {
+    double remaining = deadline - Thread::MonotonicTime();
+    if (remaining <= 0.0)
+    {
+      break;
+    }
+    mSlot->cond.timedWait(mSlot->mutex, (unsigned long)(1000.0 * remaining) + 1);
+  }
+  mSlot->mutex.unlock();
+  
+  return mSlot->done.load(MO_ACQUIRE);
+}
+
+// ---
+
+EventQueue::EventQueue(bool multiConsumer)
+  : mOwner(Thread::CurrentID()), mMultiConsumer(multiConsumer), mAcceptEvents(true)
+  , mHead(&mStub), mTail(&mStub)
+{
+  mStub.next = 0;
 }
 
 EventQueue::~EventQueue()
@@ -39,126 +159,286 @@ EventQueue::~EventQueue()
   // will this be called by the right thread?
   acceptEvents(false);
   // shall we execute remaining events if we are in the right thread
-  mEvents.clear();
+  Node *node = popNode();
+  while (node)
+  {
+    delete node;
+    node = popNode();
+  }
+}
+
+void EventQueue::pushNodes(Node *first, Node *last)
+{
+  last->next.store(0, MO_RELAXED);
+  // the list is consistent again once the previous head is linked
+  Node *prev = mHead.exchange(last, MO_ACQ_REL);
+  prev->next.store(first, MO_RELEASE);
+}
+
+EventQueue::Node* EventQueue::popNode()
+{
+  Node *tail = mTail;
+  Node *next = tail->next.load(MO_ACQUIRE);
+  
+  if (tail == &mStub)
+  {
+    if (next == 0)
+    {
+      return 0;
+    }
+    mTail = next;
+    tail = next;
+    next = next->next.load(MO_ACQUIRE);
+  }
+  
+  if (next != 0)
+  {
+    mTail = next;
+    return tail;
+  }
+  
+  if (tail != mHead.load(MO_ACQUIRE))
+  {
+    // a producer swapped the head but didn't link it yet
+    return 0;
+  }
+  
+  // tail is the last node, put the stub behind it so that it can be taken
+  pushNodes(&mStub, &mStub);
+  
+  next = tail->next.load(MO_ACQUIRE);
+  
+  if (next != 0)
+  {
+    mTail = next;
+    return tail;
+  }
+  
+  return 0;
+}
+
+size_t EventQueue::popNodes(size_t count, std::vector<Node*> &nodes)
+{
+  if (mMultiConsumer)
+  {
+    mConsumersMutex.lock();
+  }
+  
+  size_t n = 0;
+  
+  while (n < count)
+  {
+    Node *node = popNode();
+    if (!node)
+    {
+      break;
+    }
+    nodes.push_back(node);
+    ++n;
+  }
+  
+  if (mMultiConsumer)
+  {
+    mConsumersMutex.unlock();
+  }
+  
+  return n;
+}
+
+void EventQueue::run(Node *node)
+{
+  EventInfo &ei = node->info;
+  
+  ei.func();
+  
+  if (ei.done.valid())
+  {
+    ei.done.signal();
+  }
+  
+  delete node;
 }
 
 bool EventQueue::push(Event evt, bool sync)
+{
+  if (!sync)
+  {
+    Handle none;
+    return push(evt, none, false);
+  }
+  else
+  {
+    Handle done;
+    if (!push(evt, done, true))
+    {
+      return false;
+    }
+    done.wait();
+    return true;
+  }
+}
+
+bool EventQueue::push(Event evt, Handle &handle)
+{
+  return push(evt, handle, true);
+}
+
+bool EventQueue::push(Event evt, Handle &handle, bool attach)
 {
   if (Thread::CurrentID() != mOwner)
   {
-    mEventsMutex.lock();
-    
     if (!mAcceptEvents)
     {
-      mEventsMutex.unlock();
+      handle.reset(false);
       return false;
     }
     
-    size_t id = newID();
+    Node *node = new Node();
+    node->info.func = evt;
     
-    EventInfo ei = {evt, sync, id};
+    if (attach)
+    {
+      handle.reset(true);
+      node->info.done = handle;
+    }
     
-    mQueueIDs.insert(id);
-    mEvents.push_back(ei);
+    pushNodes(node, node);
+  }
+  else
+  {
+    evt();
     
-    mEventsMutex.unlock();
+    if (attach)
+    {
+      handle.reset(true);
+      handle.signal();
+    }
+  }
+  
+  return true;
+}
+
+size_t EventQueue::push(const std::vector<Event> &evts)
+{
+  if (evts.size() == 0)
+  {
+    return 0;
+  }
+  
+  if (Thread::CurrentID() != mOwner)
+  {
+    if (!mAcceptEvents)
+    {
+      return 0;
+    }
     
-    if (sync)
+    Node *first = 0;
+    Node *last = 0;
+    
+    for (size_t i=0; i<evts.size(); ++i)
     {
-      mDoneMutex.lock();
-      while (mDoneID != id)
+      Node *node = new Node();
+      node->info.func = evts[i];
+      node->next.store(0, MO_RELAXED);
+      if (last)
+      {
+        last->next.store(node, MO_RELAXED);
+      }
+      else
       {
-        mDoneCond.wait(mDoneMutex);
+        first = node;
       }
-      mDoneID = (size_t)-1;
-      mDoneMutex.unlock();
+      last = node;
     }
     
-    return true;
+    pushNodes(first, last);
   }
   else
   {
-    evt();
-    return true;
+    for (size_t i=0; i<evts.size(); ++i)
+    {
+      Event evt = evts[i];
+      evt();
+    }
   }
+  
+  return evts.size();
 }
 
 size_t EventQueue::poll(size_t count)
 {
-  if (Thread::CurrentID() != mOwner)
+  if (!mMultiConsumer && Thread::CurrentID() != mOwner)
   {
     return 0;
   }
   
-  mEventsMutex.lock();
-  
-  if (count > mEvents.size())
+  if (count == 0)
   {
-    count = mEvents.size();
+    return 0;
   }
   
-  if (count == 0)
+  if (!mMultiConsumer)
   {
-    mEventsMutex.unlock();
-    return 0;
+    // single consumer, no need to batch
+    size_t n = 0;
+    Node *node = 0;
+    
+    while (n < count && (node = popNode()) != 0)
+    {
+      run(node);
+      ++n;
+    }
+    
+    return n;
   }
   
-  EventInfoList::iterator first = mEvents.begin();
-  EventInfoList::iterator last = first + count;
+  std::vector<Node*> nodes;
   
-  EventInfoList tmp(first, last);
+  popNodes(count, nodes);
   
-  mEvents.erase(first, last);
+  for (size_t i=0; i<nodes.size(); ++i)
+  {
+    run(nodes[i]);
+  }
   
-  mEventsMutex.unlock();
+  return nodes.size();
+}
+
+size_t EventQueue::poll(size_t count, std::vector<Event> &evts)
+{
+  if (!mMultiConsumer && Thread::CurrentID() != mOwner)
+  {
+    return 0;
+  }
   
-  for (size_t i=0; i<tmp.size(); ++i)
+  std::vector<Node*> nodes;
+  size_t n = 0;
+  
+  popNodes(count, nodes);
+  
+  for (size_t i=0; i<nodes.size(); ++i)
   {
-    EventInfo &ei = tmp[i];
-    
-    ei.func();
-    
-    if (ei.sync)
+    if (nodes[i]->info.done.valid())
     {
-      mDoneMutex.lock();
-      mDoneID = ei.id;
-      while (mDoneID != (size_t)-1)
-      {
-        ScopeUnlock su(mDoneMutex);
-        mDoneCond.notify();
-      }
-      mDoneMutex.unlock();
+      run(nodes[i]);
+    }
+    else
+    {
+      evts.push_back(nodes[i]->info.func);
+      delete nodes[i];
+      ++n;
     }
-    
-    ScopeLock sl(mEventsMutex);
-    mQueueIDs.erase(mQueueIDs.find(ei.id));
   }
   
-  return count;
+  return n;
 }
 
 void EventQueue::acceptEvents(bool v)
 {
   if (Thread::CurrentID() == mOwner)
   {
-    mEventsMutex.lock();
     mAcceptEvents = v;
-    mEventsMutex.unlock();
   }
 }
 
-size_t EventQueue::newID()
-{
-  size_t id = mCurID++;
-  
-  while (mQueueIDs.find(id) != mQueueIDs.end())
-  {
-    id = mCurID++;
-  }
-  return id;
-  
-  //return mCurID++;
 }
-
-}
-
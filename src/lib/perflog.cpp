@@ -26,10 +26,17 @@ SOFTWARE.
 
 #include <gcore/perflog.h>
 #include <gcore/log.h>
+#include <gcore/threads.h>
+#include <cmath>
 #ifdef __APPLE__
 #  include <mach/clock.h>
 #  include <mach/mach.h>
 #endif
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#elif defined(__i386__) || defined(__x86_64__)
+#  include <cpuid.h>
+#endif
 
 namespace gcore
 {
@@ -66,46 +73,168 @@ static inline void clock_gettime(struct timespec *ts)
 
 static inline void clock_gettime(struct timespec *ts)
 {
-   clock_gettime(CLOCK_PROCESS_CPUTIME_ID, ts);
+   // wall time: the process cpu time would also count the other threads
+   clock_gettime(CLOCK_MONOTONIC, ts);
 }
 
 #endif
 #endif
 
+// read under the thread log lock by begin/end, switched while all of them
+// are held (see SetClockSource)
+static Atomic<int> gClockSource(PerfLog::DefaultClock);
+
+// seconds per TSC tick, calibrated once before the TSC is first selected
+static double gTSCTickSeconds = 0.0;
+
+static double DefaultTickSeconds()
+{
+#ifdef _WIN32
+   LARGE_INTEGER freq;
+   QueryPerformanceFrequency(&freq);
+   return (freq.QuadPart != 0 ? 1.0 / double(freq.QuadPart) : 0.0);
+#else
+   return 0.000000001;
+#endif
+}
+
+static inline double TickSeconds()
+{
+   return (gClockSource.load(MO_ACQUIRE) == PerfLog::TSCClock ? gTSCTickSeconds : DefaultTickSeconds());
+}
+
+#if defined(__i386__) || defined(__x86_64__) || defined(_M_IX86) || defined(_M_X64)
+
+#define PERFLOG_TSC
+
+static inline UInt64 ReadTSC()
+{
+#ifdef _MSC_VER
+   return UInt64(__rdtsc());
+#else
+   return UInt64(__builtin_ia32_rdtsc());
+#endif
+}
+
+static bool HasInvariantTSC()
+{
+#ifdef _MSC_VER
+   int regs[4];
+   __cpuid(regs, 0x80000000);
+   if ((unsigned int)regs[0] < 0x80000007)
+   {
+      return false;
+   }
+   __cpuid(regs, 0x80000007);
+   return ((regs[3] & 0x100) != 0);
+#else
+   unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+   // fails if the leaf is not supported
+   if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+   {
+      return false;
+   }
+   return ((edx & 0x100) != 0);
+#endif
+}
+
+static double CalibrateTSC()
+{
+   double w0 = Thread::MonotonicTime();
+   UInt64 t0 = ReadTSC();
+   
+   Thread::SleepCurrent(20);
+   
+   double w1 = Thread::MonotonicTime();
+   UInt64 t1 = ReadTSC();
+   
+   return (t1 > t0 && w1 > w0 ? (w1 - w0) / double(t1 - t0) : 0.0);
+}
+
+#endif
+
+PerfLog::ClockSource PerfLog::GetClockSource()
+{
+   return ClockSource(gClockSource.load(MO_ACQUIRE));
+}
+
+double PerfLog::TicksPerSecond()
+{
+   double tickSeconds = TickSeconds();
+   return (tickSeconds > 0.0 ? 1.0 / tickSeconds : 0.0);
+}
+
+void PerfLog::StackItem::Now(PerfLog::StackItem::TimeCounter &tc)
+{
+#ifdef PERFLOG_TSC
+   if (gClockSource.load(MO_RELAXED) == TSCClock)
+   {
+      tc = ReadTSC();
+      return;
+   }
+#endif
+#ifdef _WIN32
+   LARGE_INTEGER counter;
+   QueryPerformanceCounter(&counter);
+   tc = TimeCounter(counter.QuadPart);
+#else
+   struct timespec ts;
+   clock_gettime(&ts);
+   tc = TimeCounter(ts.tv_sec) * 1000000000 + TimeCounter(ts.tv_nsec);
+#endif
+}
+
+double PerfLog::StackItem::Elapsed(const TimeCounter &from, const TimeCounter &to, PerfLog::Units units)
+{
+   double ticks = (to > from ? double(to - from) : 0.0);
+   
+   return (units == Ticks ? ticks : PerfLog::ConvertUnits(ticks, Ticks, units));
+}
+
 PerfLog::StackItem::StackItem()
    : entry(0)
-   , id("")
+   , global(0)
+   , id(0)
    , recursionCount(0)
+   , wallStart(0.0)
    , selfStopped(false)
 {
-#ifdef _WIN32
-   QueryPerformanceCounter(&start);
-#else
-   clock_gettime(&start);
-#endif
+   Now(start);
    selfStart = start;
 }
 
-PerfLog::StackItem::StackItem(const std::string &_id, Entry *_entry)
+PerfLog::StackItem::StackItem(const std::string *_id, BaseEntry *_global, Entry *_entry)
    : entry(_entry)
+   , global(_global)
    , id(_id)
    , recursionCount(0)
+   , wallStart(0.0)
    , selfStopped(false)
 {
-#ifdef _WIN32
-   QueryPerformanceCounter(&start);
-#else
-   clock_gettime(&start);
-#endif
+   Now(start);
    selfStart = start;
 }
 
+PerfLog::StackItem::StackItem(const std::string *_id, BaseEntry *_global, Entry *_entry, const TimeCounter &now)
+   : entry(_entry)
+   , global(_global)
+   , id(_id)
+   , recursionCount(0)
+   , start(now)
+   , selfStart(now)
+   , wallStart(0.0)
+   , selfStopped(false)
+{
+}
+
 PerfLog::StackItem::StackItem(const PerfLog::StackItem &rhs)
    : entry(rhs.entry)
+   , global(rhs.global)
    , id(rhs.id)
    , recursionCount(rhs.recursionCount)
    , start(rhs.start)
    , selfStart(rhs.selfStart)
+   , wallStart(rhs.wallStart)
    , selfStopped(rhs.selfStopped)
 {
 }
@@ -115,10 +244,12 @@ PerfLog::StackItem& PerfLog::StackItem::operator=(const PerfLog::StackItem &rhs)
    if (this != &rhs)
    {
       entry = rhs.entry;
+      global = rhs.global;
       id = rhs.id;
       recursionCount = rhs.recursionCount;
       start = rhs.start;
       selfStart = rhs.selfStart;
+      wallStart = rhs.wallStart;
       selfStopped = rhs.selfStopped;
    }
    return *this;
@@ -126,42 +257,14 @@ PerfLog::StackItem& PerfLog::StackItem::operator=(const PerfLog::StackItem &rhs)
 
 void PerfLog::StackItem::stopAll(double &total, double &self, PerfLog::Units units)
 {
-#ifdef _WIN32
-   LARGE_INTEGER end, freq;
-   
-   QueryPerformanceFrequency(&freq);
-   
-   if (freq.QuadPart == 0)
-   {
-      total = 0;
-      self = 0;
-      return;
-   }
-   
-   QueryPerformanceCounter(&end);
-   
-   total = double(end.QuadPart - start.QuadPart) / double(freq.QuadPart);
-   total = PerfLog::ConvertUnits(total, Seconds, units);
-   
-   if (selfStopped)
-   {
-      self = 0;
-   }
-   else
-   {
-      self = double(end.QuadPart - selfStart.QuadPart) / double(freq.QuadPart);
-      self = PerfLog::ConvertUnits(self, Seconds, units);
-      selfStopped = true;
-   }
-#else
-   struct timespec to;
-   
-   clock_gettime(&to);
-   
-   double dsec  = double(to.tv_sec - start.tv_sec);
-   double dnsec = double(to.tv_nsec - start.tv_nsec);
-   
-   total = (PerfLog::ConvertUnits(dsec, Seconds, units) + PerfLog::ConvertUnits(dnsec, NanoSeconds, units));
+   TimeCounter now;
+   Now(now);
+   stopAll(now, total, self, units);
+}
+
+void PerfLog::StackItem::stopAll(const TimeCounter &now, double &total, double &self, PerfLog::Units units)
+{
+   total = Elapsed(start, now, units);
    
    if (selfStopped)
    {
@@ -169,20 +272,24 @@ void PerfLog::StackItem::stopAll(double &total, double &self, PerfLog::Units uni
    }
    else
    {
-      dsec  = double(to.tv_sec - selfStart.tv_sec);
-      dnsec = double(to.tv_nsec - selfStart.tv_nsec);
-      self = (PerfLog::ConvertUnits(dsec, Seconds, units) + PerfLog::ConvertUnits(dnsec, NanoSeconds, units));
+      self = Elapsed(selfStart, now, units);
       selfStopped = true;
    }
-#endif
 }
 
 double PerfLog::StackItem::stopSelf(PerfLog::Units units)
+{
+   TimeCounter now;
+   Now(now);
+   return stopSelf(now, units);
+}
+
+double PerfLog::StackItem::stopSelf(const TimeCounter &now, PerfLog::Units units)
 {
    if (!selfStopped)
    {
       selfStopped = true;
-      return duration(selfStart, units);
+      return Elapsed(selfStart, now, units);
    }
    else
    {
@@ -191,50 +298,130 @@ double PerfLog::StackItem::stopSelf(PerfLog::Units units)
 }
 
 void PerfLog::StackItem::startSelf()
+{
+   TimeCounter now;
+   Now(now);
+   startSelf(now);
+}
+
+void PerfLog::StackItem::startSelf(const TimeCounter &now)
 {
    if (selfStopped)
    {
-#ifdef _WIN32
-      QueryPerformanceCounter(&selfStart);
-#else
-      clock_gettime(&selfStart);
-#endif
+      selfStart = now;
       selfStopped = false;
    }
 }
 
 double PerfLog::StackItem::duration(const TimeCounter &from, PerfLog::Units units) const
 {
-#ifdef _WIN32
-   LARGE_INTEGER to, freq;
-   
-   QueryPerformanceFrequency(&freq);
-   
-   if (freq.QuadPart == 0)
+   TimeCounter now;
+   Now(now);
+   return Elapsed(from, now, units);
+}
+
+double PerfLog::StackItem::duration(PerfLog::Units units) const
+{
+   return duration(start, units);
+}
+
+// ---
+
+PerfLog::Histogram::Histogram()
+{
+   clear();
+}
+
+void PerfLog::Histogram::clear()
+{
+   memset(mCounts, 0, NumBuckets * sizeof(unsigned int));
+   mCount = 0;
+   mMax = 0.0;
+}
+
+size_t PerfLog::Histogram::Bucket(double nanoseconds)
+{
+   if (nanoseconds < double(2 * SubBuckets))
    {
-      return 0.0;
+      // exact below the first split magnitude
+      return (nanoseconds > 0.0 ? size_t(nanoseconds) : 0);
    }
    
-   QueryPerformanceCounter(&to);
+   int exp = 0;
+   frexp(nanoseconds, &exp);
    
-   double dsec = double(to.QuadPart - from.QuadPart) / double(freq.QuadPart);
+   // nanoseconds in [2^(exp-1), 2^exp[, keep the SubBucketBits bits after the leading one
+   int shift = exp - 1 - SubBucketBits;
+   size_t sub = size_t(ldexp(nanoseconds, -shift)) - SubBuckets;
+   size_t bucket = size_t(shift + 1) * SubBuckets + sub;
    
-   return PerfLog::ConvertUnits(dsec, Seconds, units);
-#else
-   struct timespec to;
-   
-   clock_gettime(&to);
+   return (bucket < size_t(NumBuckets) ? bucket : size_t(NumBuckets - 1));
+}
+
+double PerfLog::Histogram::BucketValue(size_t bucket)
+{
+   if (bucket < size_t(2 * SubBuckets))
+   {
+      return double(bucket);
+   }
    
-   double dsec  = double(to.tv_sec - from.tv_sec);
-   double dnsec = double(to.tv_nsec - from.tv_nsec);
+   int shift = int(bucket / SubBuckets) - 1;
+   double lower = ldexp(double(SubBuckets + bucket % SubBuckets), shift);
    
-   return (PerfLog::ConvertUnits(dsec, Seconds, units) + PerfLog::ConvertUnits(dnsec, NanoSeconds, units));
-#endif
+   // middle of the bucket
+   return lower + 0.5 * ldexp(1.0, shift);
 }
 
-double PerfLog::StackItem::duration(PerfLog::Units units) const
+void PerfLog::Histogram::add(double nanoseconds, size_t count)
 {
-   return duration(start, units);
+   if (count == 0)
+   {
+      return;
+   }
+   mCounts[Bucket(nanoseconds)] += (unsigned int) count;
+   mCount += count;
+   if (nanoseconds > mMax)
+   {
+      mMax = nanoseconds;
+   }
+}
+
+void PerfLog::Histogram::merge(const PerfLog::Histogram &rhs)
+{
+   for (size_t i=0; i<size_t(NumBuckets); ++i)
+   {
+      mCounts[i] += rhs.mCounts[i];
+   }
+   mCount += rhs.mCount;
+   if (rhs.mMax > mMax)
+   {
+      mMax = rhs.mMax;
+   }
+}
+
+double PerfLog::Histogram::percentile(double q) const
+{
+   if (mCount == 0)
+   {
+      return 0.0;
+   }
+   
+   // rank of the value, 1 based
+   double rank = ceil(q * double(mCount));
+   size_t target = (rank < 1.0 ? 1 : (rank > double(mCount) ? mCount : size_t(rank)));
+   size_t cumul = 0;
+   
+   for (size_t i=0; i<size_t(NumBuckets); ++i)
+   {
+      cumul += mCounts[i];
+      if (cumul >= target)
+      {
+         double val = BucketValue(i);
+         return (val < mMax ? val : mMax);
+      }
+   }
+   
+   return mMax;
 }
 
 // ---
@@ -250,6 +437,7 @@ PerfLog::BaseEntry::BaseEntry(const PerfLog::BaseEntry &rhs)
    : totalTime(rhs.totalTime)
    , selfTime(rhs.selfTime)
    , callCount(rhs.callCount)
+   , durations(rhs.durations)
 {
 }
 
@@ -260,6 +448,7 @@ PerfLog::BaseEntry& PerfLog::BaseEntry::operator=(const PerfLog::BaseEntry &rhs)
       totalTime = rhs.totalTime;
       selfTime = rhs.selfTime;
       callCount = rhs.callCount;
+      durations = rhs.durations;
    }
    return *this;
 }
@@ -269,6 +458,7 @@ void PerfLog::BaseEntry::merge(const BaseEntry &rhs)
    totalTime += rhs.totalTime;
    selfTime += rhs.selfTime;
    callCount += rhs.callCount;
+   durations.merge(rhs.durations);
 }
 
 // ---
@@ -290,6 +480,7 @@ PerfLog::Entry& PerfLog::Entry::operator=(const PerfLog::Entry &rhs)
    if (this != &rhs)
    {
       subs = rhs.subs;
+      probeSubs.clear();
    }
    return *this;
 }
@@ -324,11 +515,11 @@ void PerfLog::Entry::merge(const Entry &rhs)
 
 const char* PerfLog::UnitsString(PerfLog::Units units)
 {
-   static const char* sStrs[] = {"nanosecond(s)", "millisecond(s)", "second(s)", "minute(s)", "hour(s)"};
+   static const char* sStrs[] = {"nanosecond(s)", "millisecond(s)", "second(s)", "minute(s)", "hour(s)", "tick(s)"};
    
    int idx = int(units);
    
-   if (idx < 0 || idx > Hours)
+   if (idx < 0 || idx > Ticks)
    {
       return "(unknown units)";
    }
@@ -348,6 +539,24 @@ double PerfLog::ConvertUnits(double val, PerfLog::Units srcUnits, PerfLog::Units
       {3600000000000.0,     3600000.0,           3600.0,              60.0,                 1.0}
    };
    
+   if (srcUnits == dstUnits)
+   {
+      return val;
+   }
+   
+   if (srcUnits == Ticks)
+   {
+      val *= TickSeconds();
+      srcUnits = Seconds;
+   }
+   
+   if (dstUnits == Ticks)
+   {
+      double tickSeconds = TickSeconds();
+      val = (tickSeconds > 0.0 ? ConvertUnits(val, srcUnits, Seconds) / tickSeconds : 0.0);
+      return val;
+   }
+   
    int src = int(srcUnits);
    int dst = int(dstUnits);
    
@@ -356,15 +565,323 @@ double PerfLog::ConvertUnits(double val, PerfLog::Units srcUnits, PerfLog::Units
       return val;
    }
    
-   double rv = val * sConvertUnits[int(srcUnits)][int(dstUnits)];
-   
-   return rv;
-}
+   double rv = val * sConvertUnits[int(srcUnits)][int(dstUnits)];
+   
+   return rv;
+}
+   
+// Per-thread log, merged into the registry's retired log on thread exit
+class ThreadPerfLog
+{
+public:
+   
+   ThreadPerfLog()
+      : mLog(0)
+   {
+   }
+   
+   // only copied from the thread local initial value
+   ThreadPerfLog(const ThreadPerfLog &)
+      : mLog(0)
+   {
+   }
+   
+   ~ThreadPerfLog();
+   
+   PerfLog& get();
+   
+   bool mergeInto(PerfLog &plog)
+   {
+      if (mLog)
+      {
+         plog.merge(*mLog);
+      }
+      return true;
+   }
+   
+   bool clear()
+   {
+      if (mLog)
+      {
+         mLog->clear();
+      }
+      return true;
+   }
+   
+   // keep the log locked, counting its open scopes
+   bool hold(size_t &openScopes)
+   {
+      if (mLog)
+      {
+         mLog->lock();
+         openScopes += mLog->mEntryStack.size();
+      }
+      return true;
+   }
+   
+   bool release(bool clear)
+   {
+      if (mLog)
+      {
+         if (clear)
+         {
+            mLog->_clear();
+         }
+         mLog->unlock();
+      }
+      return true;
+   }
+   
+   bool recordEvents(size_t capacity)
+   {
+      if (mLog)
+      {
+         mLog->recordEvents(capacity);
+      }
+      return true;
+   }
+   
+   bool events(PerfLog::EventList &events)
+   {
+      if (mLog)
+      {
+         mLog->events(events);
+      }
+      return true;
+   }
+   
+private:
+   
+   ThreadPerfLog& operator=(const ThreadPerfLog &);
+   
+   PerfLog *mLog;
+};
+
+class PerfLogRegistry
+{
+public:
+   
+   // declared first, destroyed last: remaining threads logs are merged into
+   // it when the thread local is destroyed
+   Mutex retiredAccess;
+   PerfLog retired;
+   ThreadLocal<ThreadPerfLog> logs;
+   // for new threads logs
+   Atomic<size_t> eventsCapacity;
+   Atomic<size_t> numThreads;
+   
+   static PerfLogRegistry& Get()
+   {
+      static PerfLogRegistry sRegistry;
+      return sRegistry;
+   }
+   
+   bool mergeInto(ThreadPerfLog &tlog)
+   {
+      return tlog.mergeInto(*snapshot);
+   }
+   
+   bool clear(ThreadPerfLog &tlog)
+   {
+      return tlog.clear();
+   }
+   
+   bool recordEvents(ThreadPerfLog &tlog)
+   {
+      return tlog.recordEvents(eventsCapacity);
+   }
+   
+   bool collectEvents(ThreadPerfLog &tlog)
+   {
+      return tlog.events(*events);
+   }
+   
+   bool hold(ThreadPerfLog &tlog)
+   {
+      return tlog.hold(openScopes);
+   }
+   
+   bool release(ThreadPerfLog &tlog)
+   {
+      return tlog.release(clearHeld);
+   }
+   
+   // target of the snapshot or events collection in progress
+   PerfLog *snapshot;
+   PerfLog::EventList *events;
+   // clock source switch in progress
+   size_t openScopes;
+   bool clearHeld;
+   
+private:
+   
+   PerfLogRegistry()
+      : retired(PerfLog::Ticks), eventsCapacity(0), numThreads(0), snapshot(0), events(0)
+      , openScopes(0), clearHeld(false)
+   {
+   }
+};
+
+PerfLog& ThreadPerfLog::get()
+{
+   if (!mLog)
+   {
+      PerfLogRegistry &reg = PerfLogRegistry::Get();
+      // raw ticks, converted when merged or printed
+      PerfLog *log = new PerfLog(PerfLog::Ticks);
+      log->mThread = ++(reg.numThreads);
+      log->recordEvents(reg.eventsCapacity);
+      log->mLock = new Mutex();
+      // not while the clock source is being switched
+      ScopeLock lock(reg.retiredAccess);
+      mLog = log;
+   }
+   return *mLog;
+}
+
+ThreadPerfLog::~ThreadPerfLog()
+{
+   if (mLog)
+   {
+      PerfLogRegistry &reg = PerfLogRegistry::Get();
+      reg.retiredAccess.lock();
+      reg.retired.merge(*mLog);
+      reg.retiredAccess.unlock();
+      delete mLog->mLock;
+      mLog->mLock = 0;
+      delete mLog;
+   }
+}
+
+PerfLog& PerfLog::ThreadInstance()
+{
+   return PerfLogRegistry::Get().logs.get().get();
+}
+
+PerfLog& PerfLog::SharedInstance()
+{
+   return ThreadInstance();
+}
+
+void PerfLog::Snapshot(PerfLog &plog)
+{
+   PerfLogRegistry &reg = PerfLogRegistry::Get();
+   ThreadLocal<ThreadPerfLog>::EachFunc func;
+   
+   // the calling thread may be exiting, serialize snapshots
+   ScopeLock lock(reg.retiredAccess);
+   
+   plog.merge(reg.retired);
+   
+   reg.snapshot = &plog;
+   Bind(&reg, &PerfLogRegistry::mergeInto, func);
+   reg.logs.each(func);
+   reg.snapshot = 0;
+}
+
+void PerfLog::RecordEvents(size_t capacity)
+{
+   PerfLogRegistry &reg = PerfLogRegistry::Get();
+   ThreadLocal<ThreadPerfLog>::EachFunc func;
+   
+   ScopeLock lock(reg.retiredAccess);
+   
+   reg.eventsCapacity = capacity;
+   reg.retired.recordEvents(capacity);
+   
+   Bind(&reg, &PerfLogRegistry::recordEvents, func);
+   reg.logs.each(func);
+}
+
+void PerfLog::Events(PerfLog::EventList &events)
+{
+   PerfLogRegistry &reg = PerfLogRegistry::Get();
+   ThreadLocal<ThreadPerfLog>::EachFunc func;
+   
+   ScopeLock lock(reg.retiredAccess);
+   
+   reg.retired.events(events);
+   
+   reg.events = &events;
+   Bind(&reg, &PerfLogRegistry::collectEvents, func);
+   reg.logs.each(func);
+   reg.events = 0;
+}
+
+void PerfLog::WriteChromeTrace(std::ostream &os)
+{
+   EventList events;
+   Events(events);
+   WriteChromeTrace(events, os);
+}
+
+void PerfLog::WriteFoldedStacks(std::ostream &os)
+{
+   PerfLog plog;
+   Snapshot(plog);
+   plog.writeFoldedStacks(os);
+}
+
+static void WriteJSONString(std::ostream &os, const std::string &str)
+{
+   static const char *sHex = "0123456789abcdef";
+   
+   os << '"';
+   for (size_t i=0; i<str.length(); ++i)
+   {
+      unsigned char c = (unsigned char) str[i];
+      if (c == '"' || c == '\\')
+      {
+         os << '\\' << c;
+      }
+      else if (c < 0x20)
+      {
+         os << "\\u00" << sHex[c >> 4] << sHex[c & 0x0F];
+      }
+      else
+      {
+         os << c;
+      }
+   }
+   os << '"';
+}
+
+void PerfLog::WriteChromeTrace(const PerfLog::EventList &events, std::ostream &os)
+{
+   std::set<size_t> threads;
+   std::ios::fmtflags flags = os.flags();
+   std::streamsize precision = os.precision();
+   
+   // microseconds, keep sub-microsecond digits of large timestamps
+   os.setf(std::ios::fixed, std::ios::floatfield);
+   os.precision(3);
+   
+   os << "{\"traceEvents\":[";
+   
+   for (size_t i=0; i<events.size(); ++i)
+   {
+      const Event &evt = events[i];
+      
+      os << (i > 0 ? ",\n" : "\n") << "{\"name\":";
+      WriteJSONString(os, evt.id);
+      os << ",\"cat\":\"perflog\",\"ph\":\"X\",\"ts\":" << (1000000.0 * evt.start)
+         << ",\"dur\":" << (1000000.0 * evt.duration)
+         << ",\"pid\":0,\"tid\":" << evt.thread << "}";
+      
+      threads.insert(evt.thread);
+   }
+   
+   for (std::set<size_t>::iterator it=threads.begin(); it!=threads.end(); ++it)
+   {
+      os << (events.size() > 0 || it != threads.begin() ? ",\n" : "\n")
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << *it
+         << ",\"args\":{\"name\":\"thread " << *it << "\"}}";
+   }
+   
+   os << "\n],\"displayTimeUnit\":\"ms\"}" << std::endl;
    
-PerfLog& PerfLog::SharedInstance()
-{
-   static PerfLog sShared;
-   return sShared;
+   os.flags(flags);
+   os.precision(precision);
 }
 
 void PerfLog::Begin(const std::string &msg)
@@ -372,6 +889,11 @@ void PerfLog::Begin(const std::string &msg)
    SharedInstance().begin(msg);
 }
 
+void PerfLog::Begin(const PerfLog::Probe &probe)
+{
+   SharedInstance().begin(probe);
+}
+
 void PerfLog::End()
 {
    SharedInstance().end();
@@ -379,28 +901,92 @@ void PerfLog::End()
 
 void PerfLog::Print(PerfLog::Output output, int flags, int sortBy, PerfLog::Units units)
 {
-   SharedInstance().print(output, flags, sortBy, units);
+   PerfLog plog;
+   Snapshot(plog);
+   plog.print(output, flags, sortBy, units);
 }
 
 void PerfLog::Print(std::ostream &os, int flags, int sortBy, PerfLog::Units units)
 {
-   SharedInstance().print(os, flags, sortBy, units);
+   PerfLog plog;
+   Snapshot(plog);
+   plog.print(os, flags, sortBy, units);
 }
 
 void PerfLog::Print(Log &log, int flags, int sortBy, PerfLog::Units units)
 {
-   SharedInstance().print(log, flags, sortBy, units);
+   PerfLog plog;
+   Snapshot(plog);
+   plog.print(log, flags, sortBy, units);
+}
+
+bool PerfLog::SetClockSource(PerfLog::ClockSource src)
+{
+   PerfLogRegistry &reg = PerfLogRegistry::Get();
+   ThreadLocal<ThreadPerfLog>::EachFunc func;
+   
+   ScopeLock lock(reg.retiredAccess);
+   
+   if (src == gClockSource.load(MO_RELAXED))
+   {
+      return true;
+   }
+   
+   if (src == TSCClock && gTSCTickSeconds <= 0.0)
+   {
+#ifdef PERFLOG_TSC
+      if (HasInvariantTSC())
+      {
+         gTSCTickSeconds = CalibrateTSC();
+      }
+#endif
+      if (gTSCTickSeconds <= 0.0)
+      {
+         return false;
+      }
+   }
+   
+   // hold all threads logs so that no scope begins or ends while switching. A
+   // scope already open would end on the other clock, refuse to switch then
+   reg.openScopes = 0;
+   Bind(&reg, &PerfLogRegistry::hold, func);
+   reg.logs.each(func);
+   
+   // ticks of both clocks don't compare
+   reg.clearHeld = (reg.openScopes == 0);
+   if (reg.clearHeld)
+   {
+      reg.retired.clear();
+      gClockSource.store(src, MO_RELEASE);
+   }
+   
+   Bind(&reg, &PerfLogRegistry::release, func);
+   reg.logs.each(func);
+   
+   return reg.clearHeld;
 }
 
 void PerfLog::Clear()
 {
-   SharedInstance().clear();
+   PerfLogRegistry &reg = PerfLogRegistry::Get();
+   ThreadLocal<ThreadPerfLog>::EachFunc func;
+   
+   ScopeLock lock(reg.retiredAccess);
+   
+   reg.retired.clear();
+   
+   Bind(&reg, &PerfLogRegistry::clear, func);
+   reg.logs.each(func);
 }
 
 // ---
 
 PerfLog::PerfLog(PerfLog::Units units)
-   : mUnits(units)
+   : mNextEvent(0)
+   , mNumEvents(0)
+   , mThread(0)
+   , mUnits(units)
+   , mLock(0)
 {
 }
 
@@ -408,7 +994,12 @@ PerfLog::PerfLog(const PerfLog &rhs)
    : mEntries(rhs.mEntries)
    , mRootEntries(rhs.mRootEntries)
    , mEntryStack(rhs.mEntryStack)
+   , mEvents(rhs.mEvents)
+   , mNextEvent(rhs.mNextEvent)
+   , mNumEvents(rhs.mNumEvents)
+   , mThread(rhs.mThread)
    , mUnits(rhs.mUnits)
+   , mLock(0)
 {
    if (mUnits == CurrentUnits)
    {
@@ -427,39 +1018,177 @@ PerfLog& PerfLog::operator=(const PerfLog &rhs)
       mEntries = rhs.mEntries;
       mRootEntries = rhs.mRootEntries;
       mEntryStack = rhs.mEntryStack;
+      mProbes.clear();
+      mEvents = rhs.mEvents;
+      mNextEvent = rhs.mNextEvent;
+      mNumEvents = rhs.mNumEvents;
+      mThread = rhs.mThread;
       mUnits = rhs.mUnits;
    }
    return *this;
 }
 
+void PerfLog::lock() const
+{
+   if (mLock)
+   {
+      mLock->lock();
+   }
+}
+
+void PerfLog::unlock() const
+{
+   if (mLock)
+   {
+      mLock->unlock();
+   }
+}
+
 void PerfLog::clear()
+{
+   lock();
+   _clear();
+   unlock();
+}
+
+void PerfLog::_clear()
 {
    mEntries.clear();
    mRootEntries.clear();
    mEntryStack.clear();
+   mProbes.clear();
+   mNextEvent = 0;
+   mNumEvents = 0;
+}
+
+static const size_t NoProbe = size_t(-1);
+
+static size_t RegisterProbe(const std::string &id)
+{
+   static Mutex sAccess;
+   static std::map<std::string, size_t> sIndices;
+   
+   ScopeLock lock(sAccess);
+   
+   std::map<std::string, size_t>::iterator it = sIndices.find(id);
+   
+   if (it == sIndices.end())
+   {
+      size_t index = sIndices.size();
+      sIndices[id] = index;
+      return index;
+   }
+   else
+   {
+      return it->second;
+   }
+}
+
+static PerfLog::Entry* SubEntry(PerfLog::Entry *parent, size_t probe, const std::string &id)
+{
+   if (probe == NoProbe)
+   {
+      return &(parent->subs[id]);
+   }
+   
+   if (probe >= parent->probeSubs.size())
+   {
+      parent->probeSubs.resize(probe + 1, 0);
+   }
+   
+   PerfLog::Entry *&sub = parent->probeSubs[probe];
+   
+   if (!sub)
+   {
+      sub = &(parent->subs[id]);
+   }
+   
+   return sub;
+}
+
+PerfLog::Probe::Probe(const std::string &id)
+   : mId(id)
+   , mIndex(RegisterProbe(id))
+{
 }
 
 void PerfLog::begin(const std::string &id)
 {
+   begin(id, NoProbe);
+}
+
+void PerfLog::begin(const PerfLog::Probe &probe)
+{
+   begin(probe.id(), probe.index());
+}
+
+void PerfLog::begin(const std::string &id, size_t probe)
+{
+   lock();
+   
    Entry *entry = 0;
+   BaseEntry *gentry = 0;
+   const std::string *gid = 0;
+   ProbeEntries *pentries = 0;
+   
+   if (probe != NoProbe)
+   {
+      if (probe >= mProbes.size())
+      {
+         ProbeEntries none = {0, 0, 0};
+         mProbes.resize(probe + 1, none);
+      }
+      pentries = &(mProbes[probe]);
+   }
    
    // update global entry
-   BaseEntry &gentry = mEntries[id];
-   gentry.callCount += 1;
+   if (pentries && pentries->global)
+   {
+      gentry = pentries->global;
+      gid = pentries->id;
+   }
+   else
+   {
+      BaseEntryMap::iterator it = mEntries.insert(BaseEntryMap::value_type(id, BaseEntry())).first;
+      gentry = &(it->second);
+      gid = &(it->first);
+      if (pentries)
+      {
+         pentries->global = gentry;
+         pentries->id = gid;
+      }
+   }
+   
+   gentry->callCount += 1;
+   
+   // one clock read for the parent self time and the new item
+   StackItem::TimeCounter now;
+   StackItem::Now(now);
    
    size_t n = mEntryStack.size();
    bool addItem = true;
    
    if (n == 0)
    {
-      entry = &(mRootEntries[id]);
+      if (!pentries)
+      {
+         entry = &(mRootEntries[id]);
+      }
+      else
+      {
+         if (!pentries->root)
+         {
+            pentries->root = &(mRootEntries[id]);
+         }
+         entry = pentries->root;
+      }
    }
    else
    {
       // there a previous log level, accumulate
       StackItem &item = mEntryStack.back();
       
-      if (item.id == id)
+      if (item.global == gentry)
       {
          // recursive call
          addItem = false;
@@ -468,11 +1197,11 @@ void PerfLog::begin(const std::string &id)
       }
       else
       {
-         entry = &(item.entry->subs[id]);
+         entry = SubEntry(item.entry, probe, id);
          // Stop function timer temporarily
-         double duration = item.stopSelf(mUnits);
+         double duration = item.stopSelf(now, mUnits);
          // update global entry function time
-         mEntries[item.id].selfTime += duration;
+         item.global->selfTime += duration;
          // update level function time
          item.entry->selfTime += duration;
          
@@ -483,19 +1212,27 @@ void PerfLog::begin(const std::string &id)
    
    if (addItem)
    {
-      mEntryStack.push_back(StackItem(id, entry));
+      mEntryStack.push_back(StackItem(gid, gentry, entry, now));
+      if (mEvents.size() > 0)
+      {
+         mEntryStack.back().wallStart = Thread::MonotonicTime();
+      }
    }
+   
+   unlock();
 }
 
 void PerfLog::end()
 {
+   lock();
+   
    size_t n = mEntryStack.size();
    
    if (n > 0)
    {
       StackItem &item = mEntryStack.back();
       
-      BaseEntry &gentry = mEntries[item.id];
+      BaseEntry &gentry = *(item.global);
       Entry *entry = item.entry;
       
       if (--(item.recursionCount) < 0)
@@ -503,14 +1240,21 @@ void PerfLog::end()
          //double duration = item.duration(mUnits);
          //double sduration = item.stopSelf(mUnits);
          double duration, sduration;
+         StackItem::TimeCounter now;
          
-         item.stopAll(duration, sduration, mUnits);
+         StackItem::Now(now);
+         item.stopAll(now, duration, sduration, mUnits);
          
          // accumulate total time
          gentry.totalTime += duration;
          // accumulate current level total time
          entry->totalTime += duration;
          
+         // record call duration
+         double ns = ConvertUnits(duration, mUnits, NanoSeconds);
+         gentry.durations.add(ns);
+         entry->durations.add(ns);
+         
          // accumulate self time
          gentry.selfTime += sduration;
          // accumulate current level self time
@@ -519,7 +1263,22 @@ void PerfLog::end()
          if (n > 1)
          {
             // returning to previous level resets its selfStart time
-            mEntryStack[n-2].startSelf();
+            mEntryStack[n-2].startSelf(now);
+         }
+         
+         if (mEvents.size() > 0 && item.wallStart > 0.0)
+         {
+            Event &evt = mEvents[mNextEvent];
+            evt.id = *(item.id);
+            evt.start = item.wallStart;
+            evt.duration = Thread::MonotonicTime() - item.wallStart;
+            evt.depth = n - 1;
+            evt.thread = mThread;
+            mNextEvent = (mNextEvent + 1) % mEvents.size();
+            if (mNumEvents < mEvents.size())
+            {
+               ++mNumEvents;
+            }
          }
          
          mEntryStack.pop_back();
@@ -529,6 +1288,109 @@ void PerfLog::end()
          // keep timers going on until first recurence call
       }
    }
+   
+   unlock();
+}
+
+void PerfLog::add(const std::string &id, double duration, size_t count, PerfLog::Units units)
+{
+   lock();
+   
+   double d = convertUnits(duration, units, mUnits);
+   
+   BaseEntry &gentry = mEntries[id];
+   Entry *entry = 0;
+   
+   if (mEntryStack.size() == 0)
+   {
+      entry = &(mRootEntries[id]);
+   }
+   else
+   {
+      entry = &(mEntryStack.back().entry->subs[id]);
+   }
+   
+   gentry.callCount += count;
+   gentry.totalTime += d;
+   gentry.selfTime += d;
+   
+   entry->callCount += count;
+   entry->totalTime += d;
+   entry->selfTime += d;
+   
+   // no individual durations, account the average
+   if (count > 0)
+   {
+      double ns = convertUnits(duration / double(count), units, NanoSeconds);
+      gentry.durations.add(ns, count);
+      entry->durations.add(ns, count);
+   }
+   
+   unlock();
+}
+
+void PerfLog::appendEvent(const PerfLog::Event &evt)
+{
+   mEvents[mNextEvent] = evt;
+   mNextEvent = (mNextEvent + 1) % mEvents.size();
+   if (mNumEvents < mEvents.size())
+   {
+      ++mNumEvents;
+   }
+}
+
+void PerfLog::recordEvents(size_t capacity)
+{
+   lock();
+   if (capacity != mEvents.size())
+   {
+      mEvents.assign(capacity, Event());
+      mNextEvent = 0;
+      mNumEvents = 0;
+   }
+   unlock();
+}
+
+void PerfLog::events(PerfLog::EventList &events) const
+{
+   lock();
+   size_t first = (mNumEvents < mEvents.size() ? 0 : mNextEvent);
+   for (size_t i=0; i<mNumEvents; ++i)
+   {
+      events.push_back(mEvents[(first + i) % mEvents.size()]);
+   }
+   unlock();
+}
+
+void PerfLog::writeChromeTrace(std::ostream &os) const
+{
+   EventList evts;
+   events(evts);
+   WriteChromeTrace(evts, os);
+}
+
+static void WriteFolded(std::ostream &os, const PerfLog::EntryMap &entries, const std::string &path, PerfLog::Units units)
+{
+   for (PerfLog::EntryMap::const_iterator it=entries.begin(); it!=entries.end(); ++it)
+   {
+      std::string subPath = (path.length() > 0 ? path + ";" + it->first : it->first);
+      
+      double us = PerfLog::ConvertUnits(it->second.selfTime, units, PerfLog::NanoSeconds) / 1000.0;
+      
+      if (us >= 1.0)
+      {
+         os << subPath << " " << (unsigned long)(us + 0.5) << std::endl;
+      }
+      
+      WriteFolded(os, it->second.subs, subPath, units);
+   }
+}
+
+void PerfLog::writeFoldedStacks(std::ostream &os) const
+{
+   lock();
+   WriteFolded(os, mRootEntries, "", mUnits);
+   unlock();
 }
 
 bool PerfLog::empty() const
@@ -536,21 +1398,64 @@ bool PerfLog::empty() const
    return (mEntries.size() == 0);
 }
 
+static void ScaleEntry(PerfLog::BaseEntry &entry, double scale)
+{
+   entry.totalTime *= scale;
+   entry.selfTime *= scale;
+}
+
+static void ScaleEntries(PerfLog::EntryMap &entries, double scale)
+{
+   for (PerfLog::EntryMap::iterator it=entries.begin(); it!=entries.end(); ++it)
+   {
+      ScaleEntry(it->second, scale);
+      ScaleEntries(it->second.subs, scale);
+   }
+}
+
 void PerfLog::merge(const PerfLog &rhs)
 {
+   lock();
+   if (&rhs != this)
+   {
+      rhs.lock();
+   }
+   
+   // rhs entries in this log units (threads logs are in ticks)
+   BaseEntryMap scaledEntries;
+   EntryMap scaledRootEntries;
+   const BaseEntryMap *rentries = &(rhs.mEntries);
+   const EntryMap *rrootEntries = &(rhs.mRootEntries);
+   
+   if (rhs.mUnits != mUnits)
+   {
+      double scale = ConvertUnits(1.0, rhs.mUnits, mUnits);
+      
+      scaledEntries = rhs.mEntries;
+      for (BaseEntryMap::iterator it=scaledEntries.begin(); it!=scaledEntries.end(); ++it)
+      {
+         ScaleEntry(it->second, scale);
+      }
+      scaledRootEntries = rhs.mRootEntries;
+      ScaleEntries(scaledRootEntries, scale);
+      
+      rentries = &scaledEntries;
+      rrootEntries = &scaledRootEntries;
+   }
+   
    BaseEntryMap::iterator eit;
    BaseEntryMap::const_iterator reit;
    
    for (eit=mEntries.begin(); eit!=mEntries.end(); ++eit)
    {
-      reit = rhs.mEntries.find(eit->first);
-      if (reit != rhs.mEntries.end())
+      reit = rentries->find(eit->first);
+      if (reit != rentries->end())
       {
          eit->second.merge(reit->second);
       }
    }
    
-   for (reit=rhs.mEntries.begin(); reit!=rhs.mEntries.end(); ++reit)
+   for (reit=rentries->begin(); reit!=rentries->end(); ++reit)
    {
       eit = mEntries.find(reit->first);
       if (eit == mEntries.end())
@@ -564,14 +1469,14 @@ void PerfLog::merge(const PerfLog &rhs)
    
    for (rit=mRootEntries.begin(); rit!=mRootEntries.end(); ++rit)
    {
-      rrit = rhs.mRootEntries.find(rit->first);
-      if (rrit != rhs.mRootEntries.end())
+      rrit = rrootEntries->find(rit->first);
+      if (rrit != rrootEntries->end())
       {
          rit->second.merge(rrit->second);
       }
    }
    
-   for (rrit=rhs.mRootEntries.begin(); rrit!=rhs.mRootEntries.end(); ++rrit)
+   for (rrit=rrootEntries->begin(); rrit!=rrootEntries->end(); ++rrit)
    {
       rit = mRootEntries.find(rrit->first);
       if (rit == mRootEntries.end())
@@ -579,6 +1484,22 @@ void PerfLog::merge(const PerfLog &rhs)
          mRootEntries[rrit->first] = rrit->second;
       }
    }
+   
+   // keep rhs events if recording
+   if (mEvents.size() > 0 && &rhs != this)
+   {
+      size_t first = (rhs.mNumEvents < rhs.mEvents.size() ? 0 : rhs.mNextEvent);
+      for (size_t i=0; i<rhs.mNumEvents; ++i)
+      {
+         appendEvent(rhs.mEvents[(first + i) % rhs.mEvents.size()]);
+      }
+   }
+   
+   if (&rhs != this)
+   {
+      rhs.unlock();
+   }
+   unlock();
 }
 
 const char* PerfLog::unitsString(PerfLog::Units units) const
@@ -606,6 +1527,16 @@ double PerfLog::convertUnits(double val, PerfLog::Units srcUnits, PerfLog::Units
    return ConvertUnits(val, srcUnits, dstUnits);
 }
 
+PerfLog::Units PerfLog::displayUnits(PerfLog::Units units) const
+{
+   if (units == CurrentUnits)
+   {
+      units = (mUnits == Ticks ? Seconds : mUnits);
+   }
+   
+   return units;
+}
+
 void PerfLog::print(PerfLog::Output output, int flags, int sortBy, PerfLog::Units units)
 {
    if (output == ConsoleOutput)
@@ -653,6 +1584,12 @@ public:
       case PerfLog::SortNumCalls:
          mShowFlags = mShowFlags | PerfLog::ShowNumCalls;
          break;
+      case PerfLog::SortP50:
+      case PerfLog::SortP90:
+      case PerfLog::SortP99:
+      case PerfLog::SortMaxTime:
+         mShowFlags = mShowFlags | PerfLog::ShowPercentiles;
+         break;
       default:
          break;
       }
@@ -689,6 +1626,18 @@ public:
          mHeader.push_back("Function Avg.");
          mFieldLengths.push_back(mHeader.back().length());
       }
+      
+      if (mShowFlags & PerfLog::ShowPercentiles)
+      {
+         mHeader.push_back("p50");
+         mFieldLengths.push_back(mHeader.back().length());
+         mHeader.push_back("p90");
+         mFieldLengths.push_back(mHeader.back().length());
+         mHeader.push_back("p99");
+         mFieldLengths.push_back(mHeader.back().length());
+         mHeader.push_back("Max");
+         mFieldLengths.push_back(mHeader.back().length());
+      }
    }
    
    void appendLogLine(const std::string &id, const PerfLog::BaseEntry &entry)
@@ -773,6 +1722,24 @@ public:
          }
          ++field;
       }
+      
+      if (mShowFlags & PerfLog::ShowPercentiles)
+      {
+         static const double sQuantiles[] = {0.5, 0.9, 0.99, -1.0};
+         
+         for (size_t i=0; i<4; ++i)
+         {
+            std::ostringstream oss;
+            oss << PerfLog::ConvertUnits(Percentile(entry, sQuantiles[i]), PerfLog::NanoSeconds, mDstUnits);
+            lline[field] = oss.str();
+            len = lline[field].length();
+            if (len > mFieldLengths[field])
+            {
+               mFieldLengths[field] = len;
+            }
+            ++field;
+         }
+      }
    }
    
    void appendLogLines(const PerfLog::EntryMap &entries, const std::string &indent="")
@@ -1088,6 +2055,36 @@ private:
       }
    }
    
+   // q < 0 for the maximum
+   static double Percentile(const PerfLog::BaseEntry &entry, double q)
+   {
+      return (q < 0.0 ? entry.durations.max() : entry.durations.percentile(q));
+   }
+   
+   template <typename T>
+   void sortByPercentile(const std::map<std::string, T> &entries, double q, std::vector<std::string> &order)
+   {
+      std::vector<double> tt;
+      std::vector<double>::iterator lb;
+      double val;
+      size_t idx;
+      
+      order.reserve(entries.size());
+      tt.reserve(entries.size());
+      
+      typename std::map<std::string, T>::const_iterator it = entries.begin();
+      
+      while (it != entries.end())
+      {
+         val = Percentile(it->second, q);
+         lb = std::lower_bound(tt.begin(), tt.end(), val);
+         idx = lb - tt.begin();
+         tt.insert(lb, val);
+         order.insert(order.begin() + idx, it->first);
+         ++it;
+      }
+   }
+   
    template <typename T>
    void sortEntries(const std::map<std::string, T> &entries, std::vector<std::string> &order)
    {
@@ -1111,6 +2108,22 @@ private:
       {
          sortByAvgFuncTime(entries, order);
       }
+      else if (mSortFlags == PerfLog::SortP50)
+      {
+         sortByPercentile(entries, 0.5, order);
+      }
+      else if (mSortFlags == PerfLog::SortP90)
+      {
+         sortByPercentile(entries, 0.9, order);
+      }
+      else if (mSortFlags == PerfLog::SortP99)
+      {
+         sortByPercentile(entries, 0.99, order);
+      }
+      else if (mSortFlags == PerfLog::SortMaxTime)
+      {
+         sortByPercentile(entries, -1.0, order);
+      }
       else
       {
          sortById(entries, order);
@@ -1141,9 +2154,13 @@ private:
 
 void PerfLog::print(std::ostream &os, int flags, int sortBy, PerfLog::Units units)
 {
+   lock();
+   
+   units = displayUnits(units);
+   
    os << "Performances (in " << unitsString(units) << "):" << std::endl;
    
-   Logger log(flags, sortBy, mUnits, (units == CurrentUnits ? mUnits : units));
+   Logger log(flags, sortBy, mUnits, units);
    
    if (flags & ShowFlat)
    {
@@ -1174,18 +2191,24 @@ void PerfLog::print(std::ostream &os, int flags, int sortBy, PerfLog::Units unit
       os << "(Warning: Still have " << mEntryStack.size() << " entry(ies) on stack:" << std::endl;
       for (size_t i=0; i<mEntryStack.size(); ++i)
       {
-        os << "   " << mEntryStack[mEntryStack.size() - 1 - i].id << std::endl;
+        os << "   " << *(mEntryStack[mEntryStack.size() - 1 - i].id) << std::endl;
       }
       os << ")" << std::endl;
    }
+   
+   unlock();
 }
 
 void PerfLog::print(Log &log, int flags, int sortBy, PerfLog::Units units)
 {
+   lock();
+   
+   units = displayUnits(units);
+   
    log.printInfo("Performances (in %s)", unitsString(units));
    log.indent();
    
-   Logger logger(flags, sortBy, mUnits, (units == CurrentUnits ? mUnits : units));
+   Logger logger(flags, sortBy, mUnits, units);
    
    if (flags & ShowFlat)
    {
@@ -1219,10 +2242,12 @@ void PerfLog::print(Log &log, int flags, int sortBy, PerfLog::Units units)
       log.indent();
       for (size_t i=0; i<mEntryStack.size(); ++i)
       {
-         log.printWarning(mEntryStack[mEntryStack.size() - 1 - i].id.c_str());
+         log.printWarning(mEntryStack[mEntryStack.size() - 1 - i].id->c_str());
       }
       log.unIndent();
    }
+   
+   unlock();
 }
 
 // ----
@@ -1239,6 +2264,18 @@ ScopedPerfLog::ScopedPerfLog(PerfLog &plog, const std::string &key)
    mPerfLog.begin(key);
 }
 
+ScopedPerfLog::ScopedPerfLog(const PerfLog::Probe &probe)
+   : mPerfLog(PerfLog::SharedInstance())
+{
+   mPerfLog.begin(probe);
+}
+
+ScopedPerfLog::ScopedPerfLog(PerfLog &plog, const PerfLog::Probe &probe)
+   : mPerfLog(plog)
+{
+   mPerfLog.begin(probe);
+}
+
 ScopedPerfLog::~ScopedPerfLog()
 {
    mPerfLog.end();
@@ -0,0 +1,260 @@
+/*
+MIT License
+
+Copyright (c) 2009 Gaetan Guidet
+
+This file is part of gcore.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gcore/pipeline.h>
+
+namespace gcore {
+
+Pipeline::Token::Token(Pipeline *pipeline, void *item, size_t seq)
+  : mPipeline(pipeline), mItem(item), mSeq(seq), mStage(0), mResumed(false) {
+}
+
+void Pipeline::Token::run() {
+  mPipeline->process(this);
+}
+
+// ---
+
+Pipeline::Pipeline(ThreadPool &pool)
+  : mPool(pool), mGroup(pool), mHasInput(false), mMaxItems(1), mInFlight(0), mPeak(0)
+  , mRead(0), mReading(false), mExhausted(true), mRunning(false) {
+}
+
+Pipeline::~Pipeline() {
+  mGroup.wait();
+  clear();
+}
+
+void Pipeline::input(StageFunc func) {
+  ScopeLock lock(mAccess);
+  if (!mRunning) {
+    mInput = func;
+    mHasInput = true;
+  }
+}
+
+void Pipeline::addStage(StageFunc func, StageMode mode) {
+  ScopeLock lock(mAccess);
+  if (!mRunning) {
+    Stage *stage = new Stage();
+    stage->func = func;
+    stage->mode = mode;
+    stage->busy = false;
+    stage->next = 0;
+    mStages.push_back(stage);
+  }
+}
+
+size_t Pipeline::numStages() const {
+  return mStages.size();
+}
+
+void Pipeline::clear() {
+  ScopeLock lock(mAccess);
+  if (!mRunning) {
+    for (size_t i=0; i<mStages.size(); ++i) {
+      delete mStages[i];
+    }
+    mStages.clear();
+    mHasInput = false;
+  }
+}
+
+bool Pipeline::running() {
+  ScopeLock lock(mAccess);
+  return mRunning;
+}
+
+size_t Pipeline::peakItems() {
+  ScopeLock lock(mAccess);
+  return mPeak;
+}
+
+void Pipeline::cancel() {
+  ScopeLock lock(mAccess);
+  mExhausted = true;
+}
+
+size_t Pipeline::run(size_t maxItems) {
+  
+  mAccess.lock();
+  if (mRunning || !mHasInput) {
+    mAccess.unlock();
+    return 0;
+  }
+  for (size_t i=0; i<mStages.size(); ++i) {
+    mStages[i]->busy = false;
+    mStages[i]->next = 0;
+  }
+  mMaxItems = (maxItems > 0 ? maxItems : 1);
+  mInFlight = 0;
+  mPeak = 0;
+  mRead = 0;
+  mExhausted = false;
+  mReading = true;
+  mRunning = true;
+  mAccess.unlock();
+  
+  Task task;
+  Bind(this, &Pipeline::read, task);
+  
+  if (!mGroup.run(task)) {
+    // no pool, run it all in this thread
+    read();
+  }
+  
+  mGroup.wait();
+  
+  ScopeLock lock(mAccess);
+  mRunning = false;
+  return mRead;
+}
+
+void Pipeline::submit(Token *token) {
+  Task task;
+  Bind(token, &Token::run, task);
+  if (!mGroup.run(task)) {
+    token->run();
+  }
+}
+
+void Pipeline::read() {
+  
+  for (;;) {
+    
+    mAccess.lock();
+    if (mExhausted || mInFlight >= mMaxItems) {
+      // resumed by the next item leaving the pipeline
+      mReading = false;
+      mAccess.unlock();
+      return;
+    }
+    size_t seq = mRead;
+    mAccess.unlock();
+    
+    void *item = mInput(0);
+    
+    mAccess.lock();
+    if (!item) {
+      mExhausted = true;
+      mReading = false;
+      mAccess.unlock();
+      return;
+    }
+    mRead += 1;
+    mInFlight += 1;
+    if (mInFlight > mPeak) {
+      mPeak = mInFlight;
+    }
+    mAccess.unlock();
+    
+    submit(new Token(this, item, seq));
+  }
+}
+
+void Pipeline::process(Token *token) {
+  
+  while (token->mStage < mStages.size()) {
+    
+    Stage *stage = mStages[token->mStage];
+    
+    if (stage->mode == SM_PARALLEL) {
+      if (token->mItem) {
+        token->mItem = stage->func(token->mItem);
+      }
+      token->mStage += 1;
+      continue;
+    }
+    
+    if (!token->mResumed) {
+      stage->access.lock();
+      if (stage->busy || (stage->mode == SM_SERIAL_IN_ORDER && token->mSeq != stage->next)) {
+        // the token processing the stage will hand it over
+        stage->waiting[token->mSeq] = token;
+        stage->access.unlock();
+        return;
+      }
+      stage->busy = true;
+      stage->access.unlock();
+    }
+    
+    token->mResumed = false;
+    
+    // dropped items still go through serial stages to keep the sequence
+    if (token->mItem) {
+      token->mItem = stage->func(token->mItem);
+    }
+    
+    Token *next = 0;
+    
+    stage->access.lock();
+    stage->next += 1;
+    if (!stage->waiting.empty()) {
+      std::map<size_t, Token*>::iterator it = stage->waiting.begin();
+      if (stage->mode == SM_SERIAL_OUT_OF_ORDER || it->first == stage->next) {
+        next = it->second;
+        stage->waiting.erase(it);
+      }
+    }
+    if (next) {
+      next->mResumed = true;
+    } else {
+      stage->busy = false;
+    }
+    stage->access.unlock();
+    
+    if (next) {
+      submit(next);
+    }
+    
+    token->mStage += 1;
+  }
+  
+  release(token);
+}
+
+void Pipeline::release(Token *token) {
+  
+  delete token;
+  
+  mAccess.lock();
+  mInFlight -= 1;
+  bool resume = (!mExhausted && !mReading);
+  if (resume) {
+    mReading = true;
+  }
+  mAccess.unlock();
+  
+  if (resume) {
+    Task task;
+    Bind(this, &Pipeline::read, task);
+    if (!mGroup.run(task)) {
+      read();
+    }
+  }
+}
+
+}
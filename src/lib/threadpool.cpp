@@ -25,42 +25,543 @@ SOFTWARE.
 */
 
 #include <gcore/threadpool.h>
+#include <gcore/perflog.h>
+#include <gcore/platform.h>
+#include <time.h>
+
+#ifdef _WIN32
+#  define THREAD_LOCAL __declspec(thread)
+#else
+#  define THREAD_LOCAL __thread
+#endif
 
 namespace gcore {
 
-ThreadPool::Worker::Worker(ThreadPool *pool)
-  : mThr(0), mPool(pool), mProcessing(false) {
-  mThr = new Thread(this, &Worker::run, &Worker::done);
+// maximum number of tasks a worker moves from the pool queue to its own deque
+static const size_t gsMaxBatchSize = 32;
+
+// default ThreadPool::starvationLimit
+static const size_t gsDefaultStarvationLimit = 16;
+
+// elastic mode, maximum time between two growth checks (milliseconds)
+static const unsigned long gsMaxMonitorPeriod = 100;
+
+// stats histogram bucket for a duration in seconds
+static size_t HistogramBucket(double duration) {
+  size_t i = 0;
+  double us = 1000000.0 * duration;
+  while (us >= 1.0 && i+1 < ThreadPool::NumHistogramBuckets) {
+    us *= 0.5;
+    ++i;
+  }
+  return i;
+}
+
+static void AddStats(ThreadPool::WorkerStats &dst, const ThreadPool::WorkerStats &src) {
+  dst.executed += src.executed;
+  dst.steals += src.steals;
+  dst.dequeued += src.dequeued;
+  dst.queuedTime += src.queuedTime;
+  if (src.maxQueuedTime > dst.maxQueuedTime) {
+    dst.maxQueuedTime = src.maxQueuedTime;
+  }
+  dst.runningTime += src.runningTime;
+  dst.idleTime += src.idleTime;
+  for (size_t i=0; i<ThreadPool::NumHistogramBuckets; ++i) {
+    dst.queuedHistogram[i] += src.queuedHistogram[i];
+    dst.runningHistogram[i] += src.runningHistogram[i];
+  }
+}
+
+static void LogStats(PerfLog &plog, const std::string &prefix, const ThreadPool::WorkerStats &stats, size_t numWorkers) {
+  plog.add(prefix + ".queued", stats.queuedTime, stats.dequeued);
+  plog.add(prefix + ".running", stats.runningTime, stats.executed);
+  plog.add(prefix + ".idle", stats.idleTime, numWorkers);
+  plog.add(prefix + ".steals", 0.0, stats.steals);
+}
+
+// processors of each NUMA node, nodes without processors are skipped
+static void GetTopology(std::vector<Thread::CPUSet> &nodes) {
+  nodes.clear();
+  int nn = Thread::GetNodeCount();
+  for (int n=0; n<nn; ++n) {
+    Thread::CPUSet cpus = Thread::GetNodeProcessors(n);
+    if (cpus.size() > 0) {
+      nodes.push_back(cpus);
+    }
+  }
+  if (nodes.size() == 0) {
+    Thread::CPUSet cpus;
+    for (int i=0; i<Thread::GetProcessorCount(); ++i) {
+      cpus.push_back((unsigned int)i);
+    }
+    nodes.push_back(cpus);
+  }
+}
+
+// worker running in the current thread (ThreadPool::Worker is not accessible here)
+static THREAD_LOCAL void *gsCurrentWorker = 0;
+
+ThreadPool::Worker::Worker(ThreadPool *pool, size_t index, size_t node, const Thread::CPUSet &cpus)
+  : mThr(0), mPool(pool), mProcessing(false), mIndex(index), mNode(node), mCPUs(cpus)
+  , mSpawned(0), mCompleted(0), mTasksAccess(false, Mutex::AdaptiveSpinCount)
+  , mRetired(true), mExited(true), mAliveTime(0.0), mAliveSince(0.0) {
 }
 
 ThreadPool::Worker::~Worker() {
-  delete mThr;
+  if (mThr) {
+    delete mThr;
+  }
+}
+
+void ThreadPool::Worker::spawn() {
+  mRetired = false;
+  mExited = false;
+  mPool->notifyAlive(this, true);
+  if (mThr) {
+    mThr->restart();
+  } else {
+    mThr = new Thread(this, &Worker::run, &Worker::done);
+  }
 }
 
 int ThreadPool::Worker::run() {
   Task task;
+  if (mCPUs.size() > 0) {
+    Thread::PinCurrent(mCPUs);
+  }
+  gsCurrentWorker = this;
   while ((task = mPool->getTask(this)) != NullTask) {
+    double start = mPool->statsTime();
     task();
-    mPool->notifyTaskDone(this);
+    mPool->notifyTaskDone(this, start);
   }
+  mPool->notifyAlive(this, false);
+  gsCurrentWorker = 0;
   return 0;
 }
 
 void ThreadPool::Worker::done(int) {
-  // notify pool to remove this worker
+  // notify pool that this worker is done
   mPool->notifyDone(this);
 }
 
+bool ThreadPool::Worker::popTask(Task &t) {
+  ScopeLock lock(mTasksAccess);
+  if (mTasks.size() == 0) {
+    return false;
+  }
+  t = mTasks.back();
+  mTasks.pop_back();
+  mProcessing = true;
+  return true;
+}
+
+bool ThreadPool::Worker::stealTask(Task &t) {
+  ScopeLock lock(mTasksAccess);
+  if (mTasks.size() == 0) {
+    return false;
+  }
+  t = mTasks.front();
+  mTasks.pop_front();
+  return true;
+}
+
+void ThreadPool::Worker::pushTask(const Task &t) {
+  ScopeLock lock(mTasksAccess);
+  mTasks.push_back(t);
+  mSpawned += 1;
+}
+
+// ---
+
+ThreadPool::TaskQueue::TaskQueue()
+  : mSize(0), mSeq(0) {
+  for (size_t i=0; i<NumPriorities; ++i) {
+    Lane &lane = mLanes[i];
+    lane.skipped = 0;
+    lane.peak = 0;
+    lane.queued = 0;
+    lane.promoted = 0;
+  }
+}
+
+void ThreadPool::TaskQueue::push(const Task &t, ThreadPool::Priority prio, double deadline, double queued) {
+  Lane &lane = mLanes[prio < NumPriorities ? prio : PRI_LOW];
+  
+  if (deadline > 0.0) {
+    DeadlineTask dt;
+    dt.deadline = deadline;
+    dt.queued = queued;
+    dt.seq = mSeq++;
+    dt.task = t;
+    lane.deadlines.push_back(dt);
+    std::push_heap(lane.deadlines.begin(), lane.deadlines.end());
+  } else {
+    QueuedTask qt;
+    qt.task = t;
+    qt.queued = queued;
+    lane.tasks.push_back(qt);
+  }
+  
+  mSize += 1;
+  lane.queued += 1;
+  
+  size_t n = lane.tasks.size() + lane.deadlines.size();
+  if (n > lane.peak) {
+    lane.peak = n;
+  }
+}
+
+bool ThreadPool::TaskQueue::pop(Task &t, ThreadPool::Priority prio, double *queued) {
+  Lane &lane = mLanes[prio];
+  
+  if (lane.deadlines.size() > 0) {
+    std::pop_heap(lane.deadlines.begin(), lane.deadlines.end());
+    t = lane.deadlines.back().task;
+    if (queued) {
+      *queued = lane.deadlines.back().queued;
+    }
+    lane.deadlines.pop_back();
+    
+  } else if (lane.tasks.size() > 0) {
+    t = lane.tasks.front().task;
+    if (queued) {
+      *queued = lane.tasks.front().queued;
+    }
+    lane.tasks.pop_front();
+  
+  } else {
+    return false;
+  }
+  
+  mSize -= 1;
+  
+  return true;
+}
+
+bool ThreadPool::TaskQueue::pop(Task &t, size_t starvationLimit, ThreadPool::Priority *prio, double *queued) {
+  
+  if (mSize == 0) {
+    return false;
+  }
+  
+  size_t first = NumPriorities;
+  size_t picked = NumPriorities;
+  
+  for (size_t i=0; i<NumPriorities; ++i) {
+    const Lane &lane = mLanes[i];
+    if (lane.tasks.size() + lane.deadlines.size() == 0) {
+      continue;
+    }
+    if (first == NumPriorities) {
+      first = i;
+    } else if (starvationLimit > 0 && lane.skipped >= starvationLimit) {
+      picked = i;
+      break;
+    }
+  }
+  
+  if (picked == NumPriorities) {
+    picked = first;
+  } else {
+    mLanes[picked].promoted += 1;
+  }
+  
+  // lower lanes that still have tasks are passed over once more
+  for (size_t i=picked+1; i<NumPriorities; ++i) {
+    Lane &lane = mLanes[i];
+    if (lane.tasks.size() + lane.deadlines.size() > 0) {
+      lane.skipped += 1;
+    }
+  }
+  
+  mLanes[picked].skipped = 0;
+  
+  if (prio) {
+    *prio = (Priority) picked;
+  }
+  
+  return pop(t, (Priority) picked, queued);
+}
+
+void ThreadPool::TaskQueue::append(ThreadPool::TaskQueue &q) {
+  for (size_t i=0; i<NumPriorities; ++i) {
+    Lane &src = q.mLanes[i];
+    Lane &dst = mLanes[i];
+    
+    for (size_t j=0; j<src.deadlines.size(); ++j) {
+      DeadlineTask dt = src.deadlines[j];
+      dt.seq = mSeq++;
+      dst.deadlines.push_back(dt);
+      std::push_heap(dst.deadlines.begin(), dst.deadlines.end());
+    }
+    dst.tasks.insert(dst.tasks.end(), src.tasks.begin(), src.tasks.end());
+    
+    mSize += src.tasks.size() + src.deadlines.size();
+    src.tasks.clear();
+    src.deadlines.clear();
+  }
+  q.mSize = 0;
+}
+
+size_t ThreadPool::TaskQueue::size() const {
+  return mSize;
+}
+
+size_t ThreadPool::TaskQueue::size(ThreadPool::Priority prio) const {
+  const Lane &lane = mLanes[prio];
+  return lane.tasks.size() + lane.deadlines.size();
+}
+
+void ThreadPool::TaskQueue::addStats(ThreadPool::Priority prio, ThreadPool::QueueStats &stats) const {
+  const Lane &lane = mLanes[prio];
+  stats.pending += lane.tasks.size() + lane.deadlines.size();
+  // peaks of different queues don't happen at the same time
+  if (lane.peak > stats.peak) {
+    stats.peak = lane.peak;
+  }
+  stats.queued += lane.queued;
+  stats.promoted += lane.promoted;
+}
+
 // ---
 
-ThreadPool::ThreadPool()
-  : mState(TPS_STOPPED), mDriverThread(Thread::CurrentID()), mRestartWorkersCount(0) {
+ThreadPool::ThreadPool(ThreadPool::Scheduling sched)
+  : mState(TPS_STOPPED), mScheduling(sched), mPlacement(PL_NONE), mDriverThread(Thread::CurrentID())
+  , mRunningWorkers(0), mStarvationLimit(gsDefaultStarvationLimit), mRestartWorkersCount(0), mRunningHelpers(0), mSubmitted(0)
+  , mHelpersCompleted(0), mTasksEpoch(0), mSleepingWorkers(0), mMinWorkers(0)
+  , mMaxWorkers(0), mIdleTimeout(0), mMaxLatency(0), mActiveWorkers(0)
+  , mLastProgress(0.0), mMonitor(0), mMonitorRunning(false), mCollectStats(false)
+  , mStatsStart(0.0), mHelped(0)
+  , mTasksAccess(false, Mutex::AdaptiveSpinCount) {
 }
 
 ThreadPool::~ThreadPool() {
   stop();
 }
 
+ThreadPool* ThreadPool::Current() {
+  Worker *wt = (Worker*) gsCurrentWorker;
+  return (wt ? wt->mPool : 0);
+}
+
+bool ThreadPool::scheduling(ThreadPool::Scheduling sched) {
+  
+  if (Thread::CurrentID() != mDriverThread) {
+    return false;
+  }
+  
+  ScopeLock lock(mTasksAccess);
+  
+  if (mState != TPS_STOPPED) {
+    return false;
+  }
+  
+  mScheduling = sched;
+  
+  return true;
+}
+
+bool ThreadPool::placement(ThreadPool::Placement p) {
+  
+  if (Thread::CurrentID() != mDriverThread) {
+    return false;
+  }
+  
+  ScopeLock lock(mTasksAccess);
+  
+  if (mState != TPS_STOPPED) {
+    return false;
+  }
+  
+  mPlacement = p;
+  
+  return true;
+}
+
+size_t ThreadPool::numNodes() {
+  ScopeLock lock(mTasksAccess);
+  return (mNodeTasks.size() > 0 ? mNodeTasks.size() : 1);
+}
+
+bool ThreadPool::elastic(size_t minWorkers, size_t maxWorkers,
+                         unsigned long idleTimeout, unsigned long maxLatency) {
+  
+  if (Thread::CurrentID() != mDriverThread) {
+    return false;
+  }
+  
+  ScopeLock lock(mTasksAccess);
+  
+  if (mState != TPS_STOPPED) {
+    return false;
+  }
+  
+  if (maxWorkers > 0) {
+    // at least one worker has to stay around to pick up tasks
+    if (minWorkers == 0) {
+      minWorkers = 1;
+    }
+    if (maxWorkers < minWorkers) {
+      maxWorkers = minWorkers;
+    }
+  }
+  
+  mMinWorkers = minWorkers;
+  mMaxWorkers = maxWorkers;
+  mIdleTimeout = idleTimeout;
+  mMaxLatency = maxLatency;
+  
+  return true;
+}
+
+void ThreadPool::starvationLimit(size_t count) {
+  ScopeLock lock(mTasksAccess);
+  mStarvationLimit = count;
+}
+
+size_t ThreadPool::starvationLimit() {
+  ScopeLock lock(mTasksAccess);
+  return mStarvationLimit;
+}
+
+ThreadPool::QueueStats ThreadPool::queueStats(ThreadPool::Priority prio) {
+  QueueStats stats = {0, 0, 0, 0};
+  if (prio >= NumPriorities) {
+    return stats;
+  }
+  ScopeLock lock(mTasksAccess);
+  mTasks.addStats(prio, stats);
+  for (size_t i=0; i<mNodeTasks.size(); ++i) {
+    mNodeTasks[i].addStats(prio, stats);
+  }
+  return stats;
+}
+
+size_t ThreadPool::numPendingTasks() {
+  ScopeLock lock(mTasksAccess);
+  return _numPendingTasks();
+}
+
+size_t ThreadPool::_numPendingTasks() {
+  size_t n = mTasks.size();
+  for (size_t i=0; i<mNodeTasks.size(); ++i) {
+    n += mNodeTasks[i].size();
+  }
+  return n;
+}
+
+double ThreadPool::statsTime() const {
+  return (mCollectStats.load(MO_RELAXED) ? Thread::MonotonicTime() : 0.0);
+}
+
+void ThreadPool::collectStats(bool on) {
+  ScopeLock lock(mWorkersAccess);
+  if (on && !mCollectStats) {
+    mStatsStart = Thread::MonotonicTime();
+    for (size_t i=0; i<mWorkers.size(); ++i) {
+      Worker *wt = mWorkers[i];
+      wt->mTasksAccess.lock();
+      if (wt->mAliveSince > 0.0) {
+        wt->mAliveSince = mStatsStart;
+      }
+      wt->mTasksAccess.unlock();
+    }
+  }
+  mCollectStats = on;
+}
+
+void ThreadPool::resetStats() {
+  ScopeLock wlock(mWorkersAccess);
+  ScopeLock tlock(mTasksAccess);
+  
+  mStatsStart = Thread::MonotonicTime();
+  
+  for (size_t i=0; i<mWorkers.size(); ++i) {
+    Worker *wt = mWorkers[i];
+    wt->mTasksAccess.lock();
+    wt->mStats.reset();
+    wt->mAliveTime = 0.0;
+    if (wt->mAliveSince > 0.0) {
+      wt->mAliveSince = mStatsStart;
+    }
+    wt->mTasksAccess.unlock();
+  }
+  mPastStats.reset();
+  mHelped = 0;
+}
+
+ThreadPool::Stats ThreadPool::stats() {
+  Stats stats;
+  
+  ScopeLock wlock(mWorkersAccess);
+  
+  mTasksAccess.lock();
+  stats.helped = mHelped;
+  mTasksAccess.unlock();
+  
+  double now = Thread::MonotonicTime();
+  
+  stats.elapsed = (mCollectStats ? now - mStatsStart : 0.0);
+  stats.total = mPastStats;
+  stats.workers.resize(mWorkers.size());
+  
+  for (size_t i=0; i<mWorkers.size(); ++i) {
+    Worker *wt = mWorkers[i];
+    wt->mTasksAccess.lock();
+    stats.workers[i] = workerStats(wt, now);
+    wt->mTasksAccess.unlock();
+    AddStats(stats.total, stats.workers[i]);
+  }
+  
+  return stats;
+}
+
+void ThreadPool::logStats(PerfLog &plog, const std::string &prefix) {
+  Stats s = stats();
+  
+  LogStats(plog, prefix, s.total, s.workers.size());
+  
+  for (size_t i=0; i<s.workers.size(); ++i) {
+    std::ostringstream oss;
+    oss << prefix << ".worker" << i;
+    LogStats(plog, oss.str(), s.workers[i], 1);
+  }
+}
+
+void ThreadPool::dequeued(Worker *wt, double queued, double now) {
+  double duration = now - queued;
+  WorkerStats &stats = wt->mStats;
+  stats.dequeued += 1;
+  stats.queuedTime += duration;
+  if (duration > stats.maxQueuedTime) {
+    stats.maxQueuedTime = duration;
+  }
+  stats.queuedHistogram[HistogramBucket(duration)] += 1;
+}
+
+void ThreadPool::notifyAlive(Worker *wt, bool alive) {
+  // always timed: collectStats may be turned on while the worker runs
+  double now = Thread::MonotonicTime();
+  ScopeLock lock(wt->mTasksAccess);
+  if (alive) {
+    wt->mAliveSince = now;
+  } else if (wt->mAliveSince > 0.0) {
+    wt->mAliveTime += now - wt->mAliveSince;
+    wt->mAliveSince = 0.0;
+  }
+}
+
+ThreadPool::WorkerStats ThreadPool::workerStats(Worker *wt, double now) {
+  WorkerStats stats = wt->mStats;
+  if (mCollectStats) {
+    double alive = wt->mAliveTime + (wt->mAliveSince > 0.0 ? now - wt->mAliveSince : 0.0);
+    stats.idleTime = (alive > stats.runningTime ? alive - stats.runningTime : 0.0);
+  }
+  return stats;
+}
+
 size_t ThreadPool::_numIdleWorkers() {
   size_t n = 0;
   for (size_t i=0; i<mWorkers.size(); ++i) {
@@ -69,6 +570,34 @@ size_t ThreadPool::_numIdleWorkers() {
   return n;
 }
 
+bool ThreadPool::_allTasksDone() {
+  // Completion counters must be read before the submission counter: both only
+  // ever increase, so if they match, the pool was idle at some point in between
+  size_t completed = 0;
+  size_t submitted = 0;
+  
+  for (size_t i=0; i<mWorkers.size(); ++i) {
+    Worker *wt = mWorkers[i];
+    wt->mTasksAccess.lock();
+    completed += wt->mCompleted;
+    wt->mTasksAccess.unlock();
+  }
+  
+  mTasksAccess.lock();
+  completed += mHelpersCompleted;
+  submitted = mSubmitted;
+  mTasksAccess.unlock();
+  
+  for (size_t i=0; i<mWorkers.size(); ++i) {
+    Worker *wt = mWorkers[i];
+    wt->mTasksAccess.lock();
+    submitted += wt->mSpawned;
+    wt->mTasksAccess.unlock();
+  }
+  
+  return (completed == submitted);
+}
+
 size_t ThreadPool::numIdleWorkers() {
   ScopeLock lock(mWorkersAccess);
   return _numIdleWorkers();
@@ -76,7 +605,8 @@ size_t ThreadPool::numIdleWorkers() {
 
 size_t ThreadPool::numWorkers() {
   ScopeLock lock(mWorkersAccess);
-  return mWorkers.size();
+  // in elastic mode, retired workers are not counted
+  return (mMaxWorkers > 0 ? mRunningWorkers : mWorkers.size());
 }
 
 bool ThreadPool::restart() {
@@ -107,14 +637,79 @@ bool ThreadPool::start(size_t numThreads) {
     numThreads = Thread::GetProcessorCount();
   }
   
+  // in elastic mode, all potential workers are created (retired) up front
+  
+  size_t count = numThreads;
+  size_t numPermanent = numThreads;
+  
+  if (mMaxWorkers > 0) {
+    numThreads = (numThreads < mMinWorkers ? mMinWorkers : (numThreads > mMaxWorkers ? mMaxWorkers : numThreads));
+    count = mMaxWorkers;
+    numPermanent = mMinWorkers;
+  }
+  
+  // compute workers placement
+  
+  std::vector<size_t> nodes(count, 0);
+  std::vector<Thread::CPUSet> cpus(count);
+  
+  if (mPlacement != PL_NONE) {
+    std::vector<Thread::CPUSet> topology;
+    GetTopology(topology);
+    
+    size_t nn = topology.size();
+    
+    if (mPlacement == PL_COMPACT) {
+      std::vector<size_t> cpuNodes;
+      Thread::CPUSet allCPUs;
+      for (size_t n=0; n<nn; ++n) {
+        allCPUs.insert(allCPUs.end(), topology[n].begin(), topology[n].end());
+        cpuNodes.insert(cpuNodes.end(), topology[n].size(), n);
+      }
+      for (size_t i=0; i<count; ++i) {
+        size_t c = i % allCPUs.size();
+        nodes[i] = cpuNodes[c];
+        cpus[i].push_back(allCPUs[c]);
+      }
+      
+    } else {
+      for (size_t i=0; i<count; ++i) {
+        size_t n = i % nn;
+        nodes[i] = n;
+        if (mPlacement == PL_SCATTER) {
+          cpus[i].push_back(topology[n][(i / nn) % topology[n].size()]);
+        } else {
+          cpus[i] = topology[n];
+        }
+      }
+      
+      if (mPlacement == PL_NUMA_NODES) {
+        // every node queue needs a worker that never retires: with fewer
+        // permanent workers than nodes, workers grown on the other nodes
+        // have no queue of their own and use the pool queue
+        mNodeTasks.resize(nn < numPermanent ? nn : numPermanent);
+      }
+    }
+  }
+  
   // add workers
 
   mWorkersAccess.lock();
   assert(mWorkers.size() == 0);
-  mWorkers.resize(numThreads);
+  mWorkers.resize(count);
+  mRunningWorkers = numThreads;
   for (size_t i=0; i<mWorkers.size(); ++i) {
-    // threads will start straight away and be lock in getTask()
-    mWorkers[i] = new Worker(this);
+    mWorkers[i] = new Worker(this, i, nodes[i], cpus[i]);
+    if (i < numThreads) {
+      // threads will start straight away and be lock in getTask()
+      mWorkers[i]->spawn();
+    }
+  }
+  mActiveWorkers = numThreads;
+  mLastProgress = Thread::MonotonicTime();
+  if (mMaxWorkers > 0 && mMaxLatency > 0 && count > numThreads) {
+    mMonitorRunning = true;
+    mMonitor = new Thread(this, &ThreadPool::monitor, &ThreadPool::monitorDone);
   }
   mWorkersAccess.unlock();
   
@@ -141,20 +736,36 @@ bool ThreadPool::wait() {
 
   mState = TPS_WAITING;
   
-  // wait until we have no more tasks in queue
-  while (mTasks.size() > 0) {
-    mTasksChanged.wait(mTasksAccess);
-  }
-  
-  mTasksChanged.notifyAll();
-  mTasksAccess.unlock();
+  if (mScheduling == SCH_WORK_STEALING) {
+    mTasksAccess.unlock();
+    
+    // wait until every submitted task has been executed
+    mWorkersAccess.lock();
+    while (!_allTasksDone()) {
+      mWorkersChanged.wait(mWorkersAccess);
+    }
+    mWorkersAccess.unlock();
   
-  // wait for all workers to run idle
-  mWorkersAccess.lock();
-  while (_numIdleWorkers() != mWorkers.size()) {
-    mWorkersChanged.wait(mWorkersAccess);
+  } else {
+    mTasksAccess.unlock();
+    
+    // wait until we have no more tasks in queue and all workers run idle
+    // (both checked together as running tasks may still queue new ones)
+    mWorkersAccess.lock();
+    while (true) {
+      mTasksAccess.lock();
+      bool empty = (mTasks.size() == 0 && mRunningHelpers == 0);
+      for (size_t i=0; empty && i<mNodeTasks.size(); ++i) {
+        empty = (mNodeTasks[i].size() == 0);
+      }
+      mTasksAccess.unlock();
+      if (empty && _numIdleWorkers() == mWorkers.size()) {
+        break;
+      }
+      mWorkersChanged.wait(mWorkersAccess);
+    }
+    mWorkersAccess.unlock();
   }
-  mWorkersAccess.unlock();
   
   // switch back status to "running"
   mTasksAccess.lock();
@@ -181,6 +792,7 @@ bool ThreadPool::stop() {
   
   mState = TPS_STOPPED;
   mTasksChanged.notifyAll();
+  mMonitorWake.notifyAll();
   mTasksAccess.unlock();
 
   mRestartWorkersCount = numWorkers();
@@ -188,60 +800,304 @@ bool ThreadPool::stop() {
   // wait all workers to be done
 
   mWorkersAccess.lock();
-  while (mWorkers.size() > 0) {
+  while (mRunningWorkers > 0 || mMonitorRunning) {
     mWorkersChanged.wait(mWorkersAccess);
   }
+  if (mMonitor) {
+    delete mMonitor;
+    mMonitor = 0;
+  }
   mWorkersAccess.unlock();
   
+  // give back tasks left in workers deques to the pool queue so that they
+  // are not lost when the pool is restarted
+  mTasksAccess.lock();
+  mWorkersAccess.lock();
+  for (size_t i=0; i<mWorkers.size(); ++i) {
+    Worker *wt = mWorkers[i];
+    for (size_t j=0; j<wt->mTasks.size(); ++j) {
+      mTasks.push(wt->mTasks[j], PRI_NORMAL);
+    }
+    wt->mTasksAccess.lock();
+    AddStats(mPastStats, workerStats(wt, Thread::MonotonicTime()));
+    wt->mTasksAccess.unlock();
+    delete wt;
+  }
+  mWorkers.clear();
+  // node queues are rebuilt on restart, placement may have changed
+  for (size_t i=0; i<mNodeTasks.size(); ++i) {
+    mTasks.append(mNodeTasks[i]);
+  }
+  mNodeTasks.clear();
+  mSubmitted = mTasks.size();
+  mHelpersCompleted = 0;
+  mWorkersAccess.unlock();
+  mTasksAccess.unlock();
+  
   return true;
 }
 
 bool ThreadPool::runTask(Task task, bool /*wait*/) {
+  return runTask(task, PRI_NORMAL, 0);
+}
+
+bool ThreadPool::runTask(Task task, ThreadPool::Priority prio, unsigned long deadline) {
   
-  if (Thread::CurrentID() != mDriverThread) {
-    return false;
+  Worker *wt = (Worker*) gsCurrentWorker;
+  
+  if (wt && wt->mPool != this) {
+    wt = 0;
+  }
+  
+  if (mScheduling == SCH_WORK_STEALING && prio == PRI_NORMAL && deadline == 0) {
+    
+    if (wt) {
+      // called from a task: keep the child on this worker (state read without
+      // lock, tasks pushed while stopping are handed back to the pool queue)
+      if (mState == TPS_STOPPED) {
+        return false;
+      }
+      
+      wt->pushTask(task);
+      
+      // A worker that found nothing to steal increments mSleepingWorkers before
+      // looking at our deque, so if it missed the task we see its count here
+      if (mSleepingWorkers > 0) {
+        mTasksAccess.lock();
+        mTasksEpoch += 1;
+        mTasksChanged.notify();
+        mTasksAccess.unlock();
+      }
+      
+      return true;
+    }
   }
   
   mTasksAccess.lock();
   
-  if (mState != TPS_RUNNING) {
+  if (mState == TPS_STOPPED) {
     mTasksAccess.unlock();
     return false;
   }
   
-  mTasks.push_back(task);
-  mTasksChanged.notifyAll();
+  double due = (deadline > 0 ? Thread::MonotonicTime() + 0.001 * double(deadline) : 0.0);
+  
+  if (mMaxWorkers > 0 && _numPendingTasks() == 0) {
+    // queue latency is measured from now on
+    mLastProgress = Thread::MonotonicTime();
+  }
+  
+  TaskQueue *nodeQueue = nodeTasks(wt);
+  
+  if (nodeQueue) {
+    // keep the task on the calling worker's node
+    nodeQueue->push(task, prio, due, statsTime());
+    if (mScheduling == SCH_WORK_STEALING) {
+      mSubmitted += 1;
+    }
+    mTasksChanged.notifyAll();
+    mTasksAccess.unlock();
+    return true;
+  }
+  
+  mTasks.push(task, prio, due, statsTime());
+  
+  if (mScheduling == SCH_WORK_STEALING) {
+    mSubmitted += 1;
+    // a single idle worker is enough to pick the task up
+    mTasksChanged.notify();
+  } else {
+    mTasksChanged.notifyAll();
+  }
+  
   mTasksAccess.unlock();
 
   return true;
 }
 
-void ThreadPool::notifyTaskDone(Worker *wt) {
-  mWorkersAccess.lock();
-  wt->processing(false);
-  mWorkersChanged.notifyAll();
-  mWorkersAccess.unlock();
+bool ThreadPool::runTaskOnNode(size_t node, Task task, ThreadPool::Priority prio) {
+  
+  mTasksAccess.lock();
+  
+  if (mNodeTasks.size() == 0) {
+    mTasksAccess.unlock();
+    return runTask(task, prio);
+  }
+  
+  if (mState == TPS_STOPPED) {
+    mTasksAccess.unlock();
+    return false;
+  }
+  
+  if (mMaxWorkers > 0 && _numPendingTasks() == 0) {
+    mLastProgress = Thread::MonotonicTime();
+  }
+  
+  mNodeTasks[node % mNodeTasks.size()].push(task, prio, 0.0, statsTime());
+  
+  if (mScheduling == SCH_WORK_STEALING) {
+    mSubmitted += 1;
+  }
+  
+  // only the workers of that node can take it
+  mTasksChanged.notifyAll();
+  
+  mTasksAccess.unlock();
+  
+  return true;
 }
 
-void ThreadPool::notifyDone(Worker *wt) {
+bool ThreadPool::runPendingTask() {
   
-  mWorkersAccess.lock();
+  Task t = NullTask;
+  bool found = false;
+  Worker *wt = (Worker*) gsCurrentWorker;
+  
+  if (wt != 0 && wt->mPool != this) {
+    // worker of another pool, behave as any other thread
+    wt = 0;
+  }
+  
+  if (wt != 0 && mScheduling == SCH_WORK_STEALING) {
+    found = wt->popTask(t);
+  }
   
-  List<Worker*>::iterator it = std::find(mWorkers.begin(), mWorkers.end(), wt);
+  if (!found) {
+    mTasksAccess.lock();
+    TaskQueue *tasks = (mState != TPS_STOPPED ? pendingTasks(wt) : 0);
+    if (tasks != 0) {
+      double queued = 0.0;
+      found = tasks->pop(t, mStarvationLimit, 0, &queued);
+      if (mMaxWorkers > 0) {
+        mLastProgress = Thread::MonotonicTime();
+      }
+      if (wt == 0) {
+        mRunningHelpers += 1;
+      } else if (queued > 0.0) {
+        wt->mTasksAccess.lock();
+        dequeued(wt, queued, Thread::MonotonicTime());
+        wt->mTasksAccess.unlock();
+      }
+    }
+    mTasksAccess.unlock();
+  }
   
-  if (it != mWorkers.end()) {
-    delete *it;
-    mWorkers.erase(it);
-    mWorkersChanged.notify();
+  if (!found && mScheduling == SCH_WORK_STEALING) {
+    if (wt != 0) {
+      found = steal(wt, t);
+    } else {
+      // workers list may only change while the workers lock is held
+      mWorkersAccess.lock();
+      found = (mState != TPS_STOPPED && steal(0, t));
+      mWorkersAccess.unlock();
+      if (found) {
+        mTasksAccess.lock();
+        mRunningHelpers += 1;
+        mTasksAccess.unlock();
+      }
+    }
+  }
+  
+  if (!found) {
+    return false;
+  }
+  
+  t();
+  
+  if (wt != 0) {
+    // running time is accounted in the task that is helping
+    wt->mTasksAccess.lock();
+    if (mScheduling == SCH_WORK_STEALING) {
+      wt->mCompleted += 1;
+    }
+    wt->mStats.executed += 1;
+    wt->mTasksAccess.unlock();
+  } else {
+    mTasksAccess.lock();
+    mRunningHelpers -= 1;
+    mHelpersCompleted += 1;
+    mHelped += 1;
+    mTasksAccess.unlock();
+  }
+  
+  if (mState == TPS_WAITING) {
+    mWorkersAccess.lock();
+    mWorkersChanged.notifyAll();
     mWorkersAccess.unlock();
+  }
+  
+  return true;
+}
+
+void ThreadPool::notifyTaskDone(Worker *wt, double start) {
+  double now = (start > 0.0 ? Thread::MonotonicTime() : 0.0);
+  
+  wt->mTasksAccess.lock();
+  
+  WorkerStats &stats = wt->mStats;
+  stats.executed += 1;
+  if (start > 0.0) {
+    stats.runningTime += now - start;
+    stats.runningHistogram[HistogramBucket(now - start)] += 1;
+  }
+  
+  if (mScheduling == SCH_WORK_STEALING) {
+    wt->processing(false);
+    wt->mCompleted += 1;
+    wt->mTasksAccess.unlock();
+    
+    // Only wake up the driver thread if it is waiting. If wait() read this
+    // worker's counter before the update above, it changed the state before
+    // doing so, so the change is visible here
+    if (mState == TPS_WAITING) {
+      mWorkersAccess.lock();
+      mWorkersChanged.notifyAll();
+      mWorkersAccess.unlock();
+    }
     
   } else {
+    wt->mTasksAccess.unlock();
+    
+    mWorkersAccess.lock();
+    wt->processing(false);
+    mWorkersChanged.notifyAll();
     mWorkersAccess.unlock();
   }
 }
 
+void ThreadPool::notifyDone(Worker *wt) {
+  // workers are deleted by stop() once they all returned
+  mWorkersAccess.lock();
+  wt->mExited = true;
+  mRunningWorkers -= 1;
+  mWorkersChanged.notifyAll();
+  mWorkersAccess.unlock();
+}
+
+ThreadPool::TaskQueue* ThreadPool::pendingTasks(Worker *wt) {
+  // mTasksAccess must be locked
+  TaskQueue *tasks = nodeTasks(wt);
+  if (tasks && tasks->size() > 0) {
+    return tasks;
+  }
+  return (mTasks.size() > 0 ? &mTasks : 0);
+}
+
+ThreadPool::TaskQueue* ThreadPool::nodeTasks(Worker *wt) {
+  // another node's queue would move the tasks off the worker's node, the
+  // pool queue at least lets the workers of any node share them
+  if (wt != 0 && wt->mNode < mNodeTasks.size()) {
+    return &(mNodeTasks[wt->mNode]);
+  }
+  return 0;
+}
+
 Task ThreadPool::getTask(Worker *wt) {
   
+  if (mScheduling == SCH_WORK_STEALING) {
+    return getStealingTask(wt);
+  }
+  
   Task t = NullTask;
 
   mTasksAccess.lock();
@@ -252,20 +1108,39 @@ Task ThreadPool::getTask(Worker *wt) {
 
   } else {
     
+    TaskQueue *tasks = 0;
+    double idleSince = 0.0;
+    bool retire = false;
+    
     // wait until we have an available task or pool is stopped
-    while (mTasks.size() == 0 && mState != TPS_STOPPED) {
-      mTasksChanged.wait(mTasksAccess);
+    while ((tasks = pendingTasks(wt)) == 0 && mState != TPS_STOPPED) {
+      if (!idleWait(wt, idleSince)) {
+        retire = true;
+        break;
+      }
     }
     
-    if (mState == TPS_STOPPED) {
+    if (mState == TPS_STOPPED || retire) {
+      if (retire) {
+        wt->mRetired = true;
+        mActiveWorkers -= 1;
+      }
       mTasksAccess.unlock();
       
     } else {
-      assert(mTasks.size() > 0);
+      assert(tasks->size() > 0);
       // we have pending task(s)
-      t = mTasks.front();
+      double queued = 0.0;
+      tasks->pop(t, mStarvationLimit, 0, &queued);
+      if (mMaxWorkers > 0) {
+        mLastProgress = Thread::MonotonicTime();
+      }
+      if (queued > 0.0) {
+        wt->mTasksAccess.lock();
+        dequeued(wt, queued, Thread::MonotonicTime());
+        wt->mTasksAccess.unlock();
+      }
       wt->processing(true);
-      mTasks.pop_front();
       mTasksChanged.notifyAll();
       mTasksAccess.unlock();
       
@@ -275,6 +1150,239 @@ Task ThreadPool::getTask(Worker *wt) {
   return t;
 }
 
+Task ThreadPool::getStealingTask(Worker *wt) {
+  
+  Task t = NullTask;
+  size_t epoch = 0;
+  double idleSince = 0.0;
+  
+  while (true) {
+    
+    // local tasks first, most recently pushed one is the most likely to be cached
+    // (unprotected state read: at worst one more task runs after stop() was called)
+    if (mState != TPS_STOPPED && wt->popTask(t)) {
+      return t;
+    }
+    
+    mTasksAccess.lock();
+    
+    if (mState == TPS_STOPPED) {
+      mTasksAccess.unlock();
+      return NullTask;
+    }
+    
+    TaskQueue *tasks = pendingTasks(wt);
+    
+    if (tasks != 0) {
+      Priority prio = PRI_NORMAL;
+      double queued = 0.0;
+      
+      tasks->pop(t, mStarvationLimit, &prio, &queued);
+      
+      if (mMaxWorkers > 0) {
+        mLastProgress = Thread::MonotonicTime();
+      }
+      
+      // take a fair share of the lane's pending tasks at once, what isn't run
+      // straight away goes to the local deque where other workers can steal it
+      // (normal lane only and while no high priority task is waiting, other
+      // tasks have to stay ordered in the pool queue)
+      size_t n = 1;
+      if (prio == PRI_NORMAL && tasks->size(PRI_HIGH) == 0) {
+        n += tasks->size(prio) / mWorkers.size();
+        if (n > gsMaxBatchSize) {
+          n = gsMaxBatchSize;
+        }
+      }
+      
+      std::vector<Task> batch(n-1);
+      std::vector<double> batchQueued(queued > 0.0 ? n-1 : 0, 0.0);
+      for (size_t i=0; i<n-1; ++i) {
+        tasks->pop(batch[i], prio, (batchQueued.size() > 0 ? &batchQueued[i] : 0));
+      }
+      
+      wt->mTasksAccess.lock();
+      if (queued > 0.0) {
+        double now = Thread::MonotonicTime();
+        dequeued(wt, queued, now);
+        for (size_t i=0; i<batchQueued.size(); ++i) {
+          if (batchQueued[i] > 0.0) {
+            dequeued(wt, batchQueued[i], now);
+          }
+        }
+      }
+      for (size_t i=n-1; i>0; --i) {
+        // reverse order so that popTask() keeps the queue order
+        wt->mTasks.push_back(batch[i-1]);
+      }
+      wt->processing(true);
+      wt->mTasksAccess.unlock();
+      
+      if (n > 1) {
+        // let sleeping workers know there is something to steal
+        mTasksEpoch += 1;
+        mTasksChanged.notifyAll();
+      }
+      
+      mTasksAccess.unlock();
+      return t;
+    }
+    
+    epoch = mTasksEpoch;
+    mSleepingWorkers += 1;
+    
+    mTasksAccess.unlock();
+    
+    if (steal(wt, t)) {
+      mTasksAccess.lock();
+      mSleepingWorkers -= 1;
+      mTasksAccess.unlock();
+      return t;
+    }
+    
+    // nothing to steal, sleep until new tasks are pushed or become stealable
+    mTasksAccess.lock();
+    while (mState != TPS_STOPPED && pendingTasks(wt) == 0 && epoch == mTasksEpoch) {
+      if (!idleWait(wt, idleSince)) {
+        // local deque is empty: only this thread pushes to it
+        wt->mRetired = true;
+        mActiveWorkers -= 1;
+        mSleepingWorkers -= 1;
+        mTasksAccess.unlock();
+        return NullTask;
+      }
+    }
+    mSleepingWorkers -= 1;
+    mTasksAccess.unlock();
+  }
+}
+
+bool ThreadPool::idleWait(Worker *wt, double &idleSince) {
+  
+  if (mMaxWorkers == 0 || wt->mIndex < mMinWorkers) {
+    mTasksChanged.wait(mTasksAccess);
+    return true;
+  }
+  
+  double now = Thread::MonotonicTime();
+  
+  if (idleSince <= 0.0) {
+    idleSince = now;
+  }
+  
+  double remaining = 0.001 * double(mIdleTimeout) - (now - idleSince);
+  
+  if (remaining <= 0.0) {
+    return false;
+  }
+  
+  mTasksChanged.timedWait(mTasksAccess, (unsigned long)(1000.0 * remaining) + 1);
+  
+  return true;
+}
+
+int ThreadPool::monitor() {
+  
+  unsigned long period = mMaxLatency / 2 + 1;
+  if (period > gsMaxMonitorPeriod) {
+    period = gsMaxMonitorPeriod;
+  }
+  
+  mTasksAccess.lock();
+  
+  while (mState != TPS_STOPPED) {
+    
+    mMonitorWake.timedWait(mTasksAccess, period);
+    
+    if (mState == TPS_STOPPED) {
+      break;
+    }
+    
+    // all active workers busy (or blocked) for too long, add one
+    if (mActiveWorkers < mMaxWorkers && _numPendingTasks() > 0 &&
+        Thread::MonotonicTime() - mLastProgress >= 0.001 * double(mMaxLatency)) {
+      // workers lock is always acquired first (see wait)
+      mTasksAccess.unlock();
+      mWorkersAccess.lock();
+      mTasksAccess.lock();
+      if (mState != TPS_STOPPED) {
+        spawnWorker();
+      }
+      mWorkersAccess.unlock();
+    }
+  }
+  
+  mTasksAccess.unlock();
+  
+  return 0;
+}
+
+void ThreadPool::monitorDone(int) {
+  mWorkersAccess.lock();
+  mMonitorRunning = false;
+  mWorkersChanged.notifyAll();
+  mWorkersAccess.unlock();
+}
+
+bool ThreadPool::spawnWorker() {
+  // mWorkersAccess and mTasksAccess must be locked
+  bool spawned = false;
+  
+  for (size_t i=mMinWorkers; mActiveWorkers<mMaxWorkers && i<mWorkers.size(); ++i) {
+    Worker *wt = mWorkers[i];
+    // a retired thread may still be returning
+    if (wt->mRetired && wt->mExited) {
+      mRunningWorkers += 1;
+      mActiveWorkers += 1;
+      wt->spawn();
+      spawned = true;
+      break;
+    }
+  }
+  
+  if (spawned) {
+    // give the new worker a chance before growing again
+    mLastProgress = Thread::MonotonicTime();
+  }
+  
+  return spawned;
+}
+
+bool ThreadPool::steal(Worker *thief, Task &t) {
+  
+  size_t n = mWorkers.size();
+  // start with the next worker so that victims are spread among thieves
+  size_t first = (thief != 0 ? thief->mIndex + 1 : 0);
+  // with placement, first try workers on the same node (data likely local)
+  size_t passes = (thief != 0 && mPlacement != PL_NONE ? 2 : 1);
+  
+  for (size_t pass=0; pass<passes; ++pass) {
+    for (size_t i=0; i<n; ++i) {
+      Worker *victim = mWorkers[(first + i) % n];
+      
+      if (victim == thief) {
+        continue;
+      }
+      
+      if (passes > 1 && (victim->mNode == thief->mNode) != (pass == 0)) {
+        continue;
+      }
+      
+      if (victim->stealTask(t)) {
+        if (thief != 0) {
+          thief->mTasksAccess.lock();
+          thief->processing(true);
+          thief->mStats.steals += 1;
+          thief->mTasksAccess.unlock();
+        }
+        return true;
+      }
+    }
+  }
+  
+  return false;
+}
+
 bool ThreadPool::addWorkers(size_t n) {
   
   mTasksAccess.lock();
@@ -325,5 +1433,122 @@ bool ThreadPool::removeWorkers(size_t n) {
   return true;
 }
   
+// ---
+
+TaskGroup::Item::Item(TaskGroup *group, Task task)
+  : mGroup(group), mTask(task) {
+}
+
+void TaskGroup::Item::run() {
+  mTask();
+  mGroup->notifyTaskDone();
+  delete this;
+}
+
+TaskGroup::TaskGroup(ThreadPool &pool)
+  : mPool(pool), mPending(0) {
+}
+
+TaskGroup::~TaskGroup() {
+  wait();
+}
+
+bool TaskGroup::run(Task task) {
+  
+  Item *item = new Item(this, task);
+  Task t;
+  
+  Bind(item, &Item::run, t);
+  
+  mAccess.lock();
+  mPending += 1;
+  mAccess.unlock();
+  
+  if (!mPool.runTask(t)) {
+    delete item;
+    notifyTaskDone();
+    return false;
+  }
+  
+  return true;
+}
+
+void TaskGroup::notifyTaskDone() {
+  ScopeLock lock(mAccess);
+  mPending -= 1;
+  if (mPending == 0) {
+    mDone.notifyAll();
+  }
+}
+
+bool TaskGroup::done() {
+  ScopeLock lock(mAccess);
+  return (mPending == 0);
 }
 
+size_t TaskGroup::numPendingTasks() {
+  ScopeLock lock(mAccess);
+  return mPending;
+}
+
+void TaskGroup::wait() {
+  
+  while (!done()) {
+    
+    if (mPool.runPendingTask()) {
+      continue;
+    }
+    
+    // nothing left to help with, remaining tasks are running
+    mAccess.lock();
+    while (mPending > 0) {
+      mDone.wait(mAccess);
+    }
+    mAccess.unlock();
+  }
+}
+
+// ---
+
+static void RunRange(RangeFunc *func, size_t from, size_t to) {
+  (*func)(from, to);
+}
+
+size_t AutoGrainSize(ThreadPool &pool, size_t count) {
+  // a few chunks per worker so that idle workers can balance the load
+  size_t n = 4 * pool.numWorkers();
+  size_t grain = (n > 0 ? count / n : count);
+  return (grain > 0 ? grain : 1);
+}
+
+void ParallelFor(ThreadPool &pool, size_t begin, size_t end, size_t grain, RangeFunc func) {
+  
+  if (end <= begin) {
+    return;
+  }
+  
+  if (grain == 0) {
+    grain = AutoGrainSize(pool, end - begin);
+  }
+  
+  TaskGroup group(pool);
+  Task task;
+  
+  // the calling thread takes the first chunk
+  size_t first = (end - begin > grain ? begin + grain : end);
+  
+  for (size_t from=first; from<end; from+=grain) {
+    size_t to = (end - from > grain ? from + grain : end);
+    // range is stored in the task itself, no per-chunk allocation
+    Bind(RunRange, &func, from, to, task);
+    if (!group.run(task)) {
+      task();
+    }
+  }
+  
+  func(begin, first);
+  
+  group.wait();
+}
+
+}
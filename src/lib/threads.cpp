@@ -27,6 +27,10 @@ SOFTWARE.
 #include <gcore/threads.h>
 #include <gcore/platform.h>
 
+const unsigned int gcore::Mutex::AdaptiveSpinCount = 100;
+const unsigned int gcore::Latch::DefaultSpinCount = 4000;
+const unsigned int gcore::Barrier::DefaultSpinCount = 4000;
+
 
 #ifdef _WIN32
 
@@ -34,7 +38,8 @@ SOFTWARE.
 
 #define MUTEX *((HANDLE*)&(mData[0]))
 
-gcore::Mutex::Mutex(bool) {
+gcore::Mutex::Mutex(bool, unsigned int spinCount)
+  : mSpinCount(spinCount > 0 && Thread::GetProcessorCount() > 1 ? spinCount : 0) {
   MUTEX = CreateMutex(NULL, FALSE, NULL);
 }
 
@@ -43,6 +48,12 @@ gcore::Mutex::~Mutex() {
 }
 
 void gcore::Mutex::lock() {
+  for (unsigned int i=0; i<mSpinCount; ++i) {
+    if (WaitForSingleObject(MUTEX, 0) == WAIT_OBJECT_0) {
+      return;
+    }
+    internal::CpuPause();
+  }
   WaitForSingleObject(MUTEX, INFINITE);
 }
 
@@ -56,8 +67,10 @@ void gcore::Mutex::unlock() {
 
 #else
 
-gcore::Mutex::Mutex(bool) {
-  InitializeCriticalSection((CRITICAL_SECTION*)&mData);
+gcore::Mutex::Mutex(bool, unsigned int spinCount)
+  : mSpinCount(spinCount > 0 && Thread::GetProcessorCount() > 1 ? spinCount : 0) {
+  // critical sections natively support spinning before waiting
+  InitializeCriticalSectionAndSpinCount((CRITICAL_SECTION*)&mData, mSpinCount);
 }
 
 gcore::Mutex::~Mutex() {
@@ -397,7 +410,8 @@ bool gcore::Semaphore::tryDecrement() {
 
 #else // _WIN32
 
-gcore::Mutex::Mutex(bool recursive) {
+gcore::Mutex::Mutex(bool recursive, unsigned int spinCount)
+  : mSpinCount(spinCount > 0 && Thread::GetProcessorCount() > 1 ? spinCount : 0) {
   pthread_mutexattr_t attr;
   pthread_mutexattr_init(&attr);
   pthread_mutexattr_settype(&attr, (recursive?PTHREAD_MUTEX_RECURSIVE:PTHREAD_MUTEX_DEFAULT));
@@ -410,6 +424,14 @@ gcore::Mutex::~Mutex() {
 }
 
 void gcore::Mutex::lock() {
+  // adaptive mode: the owner is likely to release the lock shortly,
+  // avoid the cost of putting this thread to sleep and waking it up
+  for (unsigned int i=0; i<mSpinCount; ++i) {
+    if (pthread_mutex_trylock((pthread_mutex_t*)mData) == 0) {
+      return;
+    }
+    internal::CpuPause();
+  }
   pthread_mutex_lock((pthread_mutex_t*)mData);
 }
 
@@ -937,6 +959,13 @@ void gcore::Thread::YieldCurrent() {
   Sleep(0);
 }
 
+double gcore::Thread::MonotonicTime() {
+  LARGE_INTEGER counter, freq;
+  QueryPerformanceCounter(&counter);
+  QueryPerformanceFrequency(&freq);
+  return double(counter.QuadPart) / double(freq.QuadPart);
+}
+
 gcore::ThreadID gcore::Thread::CurrentID() {
   return (void*) GetCurrentThreadId();
 }
@@ -947,6 +976,78 @@ int gcore::Thread::GetProcessorCount() {
   return int(info.dwNumberOfProcessors);
 }
 
+namespace details {
+  static DWORD_PTR CPUSetToMask(const gcore::Thread::CPUSet &cpus) {
+    DWORD_PTR mask = 0;
+    for (size_t i=0; i<cpus.size(); ++i) {
+      if (cpus[i] < 8 * sizeof(DWORD_PTR)) {
+        mask |= (DWORD_PTR(1) << cpus[i]);
+      }
+    }
+    return mask;
+  }
+  
+  static gcore::Thread::CPUSet MaskToCPUSet(ULONGLONG mask) {
+    gcore::Thread::CPUSet cpus;
+    for (unsigned int i=0; i<8*sizeof(ULONGLONG); ++i) {
+      if ((mask & (ULONGLONG(1) << i)) != 0) {
+        cpus.push_back(i);
+      }
+    }
+    return cpus;
+  }
+}
+
+gcore::Thread::CPUSet gcore::Thread::affinity() const {
+  if (mRunning) {
+    // there's no getter, set the process mask and restore the previous one
+    DWORD_PTR procMask = 0, sysMask = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &procMask, &sysMask)) {
+      DWORD_PTR prevMask = SetThreadAffinityMask((HANDLE)mSelf, procMask);
+      if (prevMask != 0) {
+        SetThreadAffinityMask((HANDLE)mSelf, prevMask);
+        return details::MaskToCPUSet(prevMask);
+      }
+    }
+  }
+  return CPUSet();
+}
+
+bool gcore::Thread::affinity(const gcore::Thread::CPUSet &cpus) {
+  if (mRunning) {
+    DWORD_PTR mask = details::CPUSetToMask(cpus);
+    return (mask != 0 && SetThreadAffinityMask((HANDLE)mSelf, mask) != 0);
+  }
+  return false;
+}
+
+bool gcore::Thread::PinCurrent(const gcore::Thread::CPUSet &cpus) {
+  DWORD_PTR mask = details::CPUSetToMask(cpus);
+  return (mask != 0 && SetThreadAffinityMask(GetCurrentThread(), mask) != 0);
+}
+
+int gcore::Thread::GetNodeCount() {
+  ULONG highest = 0;
+  if (GetNumaHighestNodeNumber(&highest)) {
+    return int(highest) + 1;
+  }
+  return 1;
+}
+
+gcore::Thread::CPUSet gcore::Thread::GetNodeProcessors(int node) {
+  ULONGLONG mask = 0;
+  if (node >= 0 && GetNumaNodeProcessorMask((UCHAR)node, &mask)) {
+    return details::MaskToCPUSet(mask);
+  }
+  CPUSet cpus;
+  if (node == 0) {
+    for (int i=0; i<GetProcessorCount(); ++i) {
+      cpus.push_back((unsigned int)i);
+    }
+  }
+  return cpus;
+}
+
 #else
 
 // #ifdef __APPLE__
@@ -1226,6 +1327,18 @@ void gcore::Thread::YieldCurrent() {
   sched_yield();
 }
 
+double gcore::Thread::MonotonicTime() {
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return double(ts.tv_sec) + 0.000000001 * double(ts.tv_nsec);
+#else
+  struct timeval tv;
+  gettimeofday(&tv, 0);
+  return double(tv.tv_sec) + 0.000001 * double(tv.tv_usec);
+#endif
+}
+
 gcore::ThreadID gcore::Thread::CurrentID() {
   return (ThreadID)pthread_self();
 }
@@ -1242,5 +1355,739 @@ int gcore::Thread::GetProcessorCount() {
 //#endif
 }
 
+namespace details {
+  // parse linux sysfs lists such as "0-3,8,10-11"
+  static void ParseIndexList(const char *str, gcore::Thread::CPUSet &indices) {
+    while (*str != '\0') {
+      char *end = 0;
+      long first = strtol(str, &end, 10);
+      if (end == str) {
+        break;
+      }
+      long last = first;
+      str = end;
+      if (*str == '-') {
+        last = strtol(str + 1, &end, 10);
+        str = end;
+      }
+      for (long i=first; i<=last; ++i) {
+        indices.push_back((unsigned int)i);
+      }
+      if (*str != ',') {
+        break;
+      }
+      ++str;
+    }
+  }
+  
+  static bool ReadIndexList(const char *path, gcore::Thread::CPUSet &indices) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+      return false;
+    }
+    char buffer[1024];
+    bool rv = (fgets(buffer, sizeof(buffer), f) != 0);
+    fclose(f);
+    if (rv) {
+      ParseIndexList(buffer, indices);
+    }
+    return rv;
+  }
+}
+
+#ifdef __linux__
+
+gcore::Thread::CPUSet gcore::Thread::affinity() const {
+  CPUSet cpus;
+  if (mRunning) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np((pthread_t)mSelf, sizeof(cpu_set_t), &set) == 0) {
+      for (unsigned int i=0; i<CPU_SETSIZE; ++i) {
+        if (CPU_ISSET(i, &set)) {
+          cpus.push_back(i);
+        }
+      }
+    }
+  }
+  return cpus;
+}
+
+bool gcore::Thread::affinity(const gcore::Thread::CPUSet &cpus) {
+  if (mRunning && cpus.size() > 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i=0; i<cpus.size(); ++i) {
+      if (cpus[i] < CPU_SETSIZE) {
+        CPU_SET(cpus[i], &set);
+      }
+    }
+    return (pthread_setaffinity_np((pthread_t)mSelf, sizeof(cpu_set_t), &set) == 0);
+  }
+  return false;
+}
+
+bool gcore::Thread::PinCurrent(const gcore::Thread::CPUSet &cpus) {
+  if (cpus.size() > 0) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (size_t i=0; i<cpus.size(); ++i) {
+      if (cpus[i] < CPU_SETSIZE) {
+        CPU_SET(cpus[i], &set);
+      }
+    }
+    return (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0);
+  }
+  return false;
+}
+
+#else
+
+// no affinity control (i.e. OSX only has affinity 'tags' hints)
+
+gcore::Thread::CPUSet gcore::Thread::affinity() const {
+  return CPUSet();
+}
+
+bool gcore::Thread::affinity(const gcore::Thread::CPUSet &) {
+  return false;
+}
+
+bool gcore::Thread::PinCurrent(const gcore::Thread::CPUSet &) {
+  return false;
+}
+
+#endif
+
+int gcore::Thread::GetNodeCount() {
+  CPUSet nodes;
+  if (details::ReadIndexList("/sys/devices/system/node/online", nodes) && nodes.size() > 0) {
+    return int(nodes.back()) + 1;
+  }
+  return 1;
+}
+
+gcore::Thread::CPUSet gcore::Thread::GetNodeProcessors(int node) {
+  CPUSet cpus;
+  char path[256];
+  sprintf(path, "/sys/devices/system/node/node%d/cpulist", node);
+  if (!details::ReadIndexList(path, cpus) && node == 0) {
+    // not a NUMA system: a single node with all processors
+    for (int i=0; i<GetProcessorCount(); ++i) {
+      cpus.push_back((unsigned int)i);
+    }
+  }
+  return cpus;
+}
+
+#endif
+
+// ---
+
+#if defined(_WIN32)
+
+#define EVENT *((HANDLE*)&(mData[0]))
+
+gcore::SyncEvent::SyncEvent(bool autoReset, bool initialState)
+  : mAutoReset(autoReset) {
+  EVENT = CreateEvent(NULL, (autoReset ? FALSE : TRUE), (initialState ? TRUE : FALSE), NULL);
+}
+
+gcore::SyncEvent::~SyncEvent() {
+  CloseHandle(EVENT);
+}
+
+void gcore::SyncEvent::set() {
+  SetEvent(EVENT);
+}
+
+void gcore::SyncEvent::reset() {
+  ResetEvent(EVENT);
+}
+
+bool gcore::SyncEvent::isSet() const {
+  HANDLE evt = *((HANDLE*)&(mData[0]));
+  if (WaitForSingleObject(evt, 0) == WAIT_OBJECT_0) {
+    if (mAutoReset) {
+      // waiting consumed it
+      SetEvent(evt);
+    }
+    return true;
+  }
+  return false;
+}
+
+void gcore::SyncEvent::wait() {
+  WaitForSingleObject(EVENT, INFINITE);
+}
+
+bool gcore::SyncEvent::timedWait(unsigned long msec) {
+  return (WaitForSingleObject(EVENT, msec) == WAIT_OBJECT_0);
+}
+
+#elif defined(__linux__)
+
+#include <new>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <climits>
+
+namespace details {
+  struct FutexEvent {
+    gcore::Atomic<int> state; // 1 when set
+    gcore::Atomic<int> waiters;
+  };
+  
+  // sleep as long as *addr == val (checked atomically by the kernel)
+  static int FutexWait(gcore::Atomic<int> *addr, int val, const struct timespec *timeout) {
+    return (int) syscall(SYS_futex, (volatile int*)addr, FUTEX_WAIT_PRIVATE, val, timeout, NULL, 0);
+  }
+  
+  static void FutexWake(gcore::Atomic<int> *addr, int count) {
+    syscall(SYS_futex, (volatile int*)addr, FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+  }
+  
+  static bool ConsumeEvent(FutexEvent *evt, bool autoReset) {
+    if (autoReset) {
+      int expected = 1;
+      return evt->state.compareExchange(expected, 0, gcore::MO_ACQUIRE);
+    } else {
+      return (evt->state.load(gcore::MO_ACQUIRE) == 1);
+    }
+  }
+}
+
+gcore::SyncEvent::SyncEvent(bool autoReset, bool initialState)
+  : mAutoReset(autoReset) {
+  assert(sizeof(mData) >= sizeof(details::FutexEvent));
+  details::FutexEvent *evt = new (mData) details::FutexEvent();
+  evt->state.store(initialState ? 1 : 0);
+}
+
+gcore::SyncEvent::~SyncEvent() {
+  ((details::FutexEvent*)mData)->~FutexEvent();
+}
+
+void gcore::SyncEvent::set() {
+  details::FutexEvent *evt = (details::FutexEvent*)mData;
+  // waiters register before checking the state: either they see the new
+  // state or we see them (both accesses are sequentially consistent)
+  if (mAutoReset) {
+    evt->state.store(1);
+    if (evt->waiters.load() > 0) {
+      details::FutexWake(&(evt->state), 1);
+    }
+  } else {
+    if (evt->state.exchange(1) == 0 && evt->waiters.load() > 0) {
+      details::FutexWake(&(evt->state), INT_MAX);
+    }
+  }
+}
+
+void gcore::SyncEvent::reset() {
+  ((details::FutexEvent*)mData)->state.store(0);
+}
+
+bool gcore::SyncEvent::isSet() const {
+  return (((details::FutexEvent*)mData)->state.load() == 1);
+}
+
+void gcore::SyncEvent::wait() {
+  details::FutexEvent *evt = (details::FutexEvent*)mData;
+  if (details::ConsumeEvent(evt, mAutoReset)) {
+    return;
+  }
+  evt->waiters.fetchAdd(1);
+  while (!details::ConsumeEvent(evt, mAutoReset)) {
+    details::FutexWait(&(evt->state), 0, NULL);
+  }
+  evt->waiters.fetchSub(1);
+}
+
+bool gcore::SyncEvent::timedWait(unsigned long msec) {
+  details::FutexEvent *evt = (details::FutexEvent*)mData;
+  if (details::ConsumeEvent(evt, mAutoReset)) {
+    return true;
+  }
+  
+  // futex timeout is relative, compute the remaining time after each wake up
+  struct timespec now, deadline, remain;
+  clock_gettime(CLOCK_MONOTONIC, &deadline);
+  deadline.tv_sec += msec / 1000;
+  deadline.tv_nsec += (msec % 1000) * 1000000;
+  if (deadline.tv_nsec >= 1000000000) {
+    deadline.tv_sec += 1;
+    deadline.tv_nsec -= 1000000000;
+  }
+  
+  bool rv = false;
+  
+  evt->waiters.fetchAdd(1);
+  for (;;) {
+    if (details::ConsumeEvent(evt, mAutoReset)) {
+      rv = true;
+      break;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    remain.tv_sec = deadline.tv_sec - now.tv_sec;
+    remain.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+    if (remain.tv_nsec < 0) {
+      remain.tv_sec -= 1;
+      remain.tv_nsec += 1000000000;
+    }
+    if (remain.tv_sec < 0) {
+      break;
+    }
+    details::FutexWait(&(evt->state), 0, &remain);
+  }
+  evt->waiters.fetchSub(1);
+  
+  return rv;
+}
+
+#else
+
+namespace details {
+  struct CondEvent {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool state;
+  };
+}
+
+gcore::SyncEvent::SyncEvent(bool autoReset, bool initialState)
+  : mAutoReset(autoReset) {
+  assert(sizeof(mData) >= sizeof(details::CondEvent));
+  details::CondEvent *evt = (details::CondEvent*)mData;
+  pthread_mutex_init(&(evt->mutex), NULL);
+  pthread_cond_init(&(evt->cond), NULL);
+  evt->state = initialState;
+}
+
+gcore::SyncEvent::~SyncEvent() {
+  details::CondEvent *evt = (details::CondEvent*)mData;
+  pthread_cond_destroy(&(evt->cond));
+  pthread_mutex_destroy(&(evt->mutex));
+}
+
+void gcore::SyncEvent::set() {
+  details::CondEvent *evt = (details::CondEvent*)mData;
+  pthread_mutex_lock(&(evt->mutex));
+  evt->state = true;
+  if (mAutoReset) {
+    pthread_cond_signal(&(evt->cond));
+  } else {
+    pthread_cond_broadcast(&(evt->cond));
+  }
+  pthread_mutex_unlock(&(evt->mutex));
+}
+
+void gcore::SyncEvent::reset() {
+  details::CondEvent *evt = (details::CondEvent*)mData;
+  pthread_mutex_lock(&(evt->mutex));
+  evt->state = false;
+  pthread_mutex_unlock(&(evt->mutex));
+}
+
+bool gcore::SyncEvent::isSet() const {
+  details::CondEvent *evt = (details::CondEvent*)mData;
+  pthread_mutex_lock(&(evt->mutex));
+  bool rv = evt->state;
+  pthread_mutex_unlock(&(evt->mutex));
+  return rv;
+}
+
+void gcore::SyncEvent::wait() {
+  details::CondEvent *evt = (details::CondEvent*)mData;
+  pthread_mutex_lock(&(evt->mutex));
+  while (!evt->state) {
+    pthread_cond_wait(&(evt->cond), &(evt->mutex));
+  }
+  if (mAutoReset) {
+    evt->state = false;
+  }
+  pthread_mutex_unlock(&(evt->mutex));
+}
+
+bool gcore::SyncEvent::timedWait(unsigned long msec) {
+  details::CondEvent *evt = (details::CondEvent*)mData;
+  
+  struct timespec ts;
+  struct timeval tv;
+  
+  gettimeofday(&tv,0);
+  
+  ts.tv_nsec  = (tv.tv_usec * 1000) + ((msec % 1000) * 1000000);
+  ts.tv_sec   = tv.tv_sec + (msec / 1000) + (ts.tv_nsec / 1000000000);
+  ts.tv_nsec %= 1000000000;
+  
+  int rval = 0;
+  
+  pthread_mutex_lock(&(evt->mutex));
+  while (!evt->state && rval != ETIMEDOUT) {
+    rval = pthread_cond_timedwait(&(evt->cond), &(evt->mutex), &ts);
+  }
+  bool rv = evt->state;
+  if (rv && mAutoReset) {
+    evt->state = false;
+  }
+  pthread_mutex_unlock(&(evt->mutex));
+  
+  return rv;
+}
+
+#endif
+
+// ---
+
+#ifdef _WIN32
+
+#define TLS_KEY *((DWORD*)&(mKey[0]))
+
+static VOID NTAPI _ThreadLocalExit(PVOID data) {
+  gcore::ThreadLocalBase::ThreadExit(data);
+}
+
+gcore::ThreadLocalBase::ThreadLocalBase()
+  : mSlots(0), mValid(false) {
+  // fiber local storage: unlike TlsAlloc, it has a destructor callback
+  TLS_KEY = FlsAlloc(_ThreadLocalExit);
+  mValid = (TLS_KEY != FLS_OUT_OF_INDEXES);
+}
+
+gcore::ThreadLocalBase::Slot* gcore::ThreadLocalBase::slot() const {
+  return (mValid ? (Slot*) FlsGetValue(TLS_KEY) : 0);
+}
+
+void gcore::ThreadLocalBase::attach(gcore::ThreadLocalBase::Slot *s) {
+  mSlotsAccess.lock();
+  s->prev = 0;
+  s->next = mSlots;
+  if (mSlots) {
+    mSlots->prev = s;
+  }
+  mSlots = s;
+  mSlotsAccess.unlock();
+  if (mValid) {
+    FlsSetValue(TLS_KEY, s);
+  }
+}
+
+void gcore::ThreadLocalBase::cleanup() {
+  if (mValid) {
+    // FlsFree calls the callback for the values still set, they get released
+    FlsFree(TLS_KEY);
+    mValid = false;
+  }
+  mSlotsAccess.lock();
+  Slot *s = mSlots;
+  mSlots = 0;
+  mSlotsAccess.unlock();
+  while (s) {
+    Slot *next = s->next;
+    destroySlot(s);
+    s = next;
+  }
+}
+
+#else
+
+#define TLS_KEY *((pthread_key_t*)&(mKey[0]))
+
+gcore::ThreadLocalBase::ThreadLocalBase()
+  : mSlots(0), mValid(false) {
+  assert(sizeof(mKey) >= sizeof(pthread_key_t));
+  mValid = (pthread_key_create((pthread_key_t*)&(mKey[0]), &ThreadExit) == 0);
+}
+
+gcore::ThreadLocalBase::Slot* gcore::ThreadLocalBase::slot() const {
+  return (mValid ? (Slot*) pthread_getspecific(TLS_KEY) : 0);
+}
+
+void gcore::ThreadLocalBase::attach(gcore::ThreadLocalBase::Slot *s) {
+  mSlotsAccess.lock();
+  s->prev = 0;
+  s->next = mSlots;
+  if (mSlots) {
+    mSlots->prev = s;
+  }
+  mSlots = s;
+  mSlotsAccess.unlock();
+  if (mValid) {
+    pthread_setspecific(TLS_KEY, s);
+  }
+}
+
+void gcore::ThreadLocalBase::cleanup() {
+  if (mValid) {
+    // no destructor is called for the values still set
+    pthread_key_delete(TLS_KEY);
+    mValid = false;
+  }
+  mSlotsAccess.lock();
+  Slot *s = mSlots;
+  mSlots = 0;
+  mSlotsAccess.unlock();
+  while (s) {
+    Slot *next = s->next;
+    destroySlot(s);
+    s = next;
+  }
+}
+
 #endif
 
+gcore::ThreadLocalBase::~ThreadLocalBase() {
+  // values can only be destroyed by the derived class (see cleanup)
+  if (mValid) {
+#ifdef _WIN32
+    FlsFree(TLS_KEY);
+#else
+    pthread_key_delete(TLS_KEY);
+#endif
+  }
+}
+
+size_t gcore::ThreadLocalBase::count() const {
+  size_t n = 0;
+  mSlotsAccess.lock();
+  for (Slot *s=mSlots; s!=0; s=s->next) {
+    ++n;
+  }
+  mSlotsAccess.unlock();
+  return n;
+}
+
+void gcore::ThreadLocalBase::release(gcore::ThreadLocalBase::Slot *s) {
+  mSlotsAccess.lock();
+  if (s->prev) {
+    s->prev->next = s->next;
+  } else {
+    mSlots = s->next;
+  }
+  if (s->next) {
+    s->next->prev = s->prev;
+  }
+  mSlotsAccess.unlock();
+  destroySlot(s);
+}
+
+void gcore::ThreadLocalBase::ThreadExit(void *data) {
+  Slot *s = (Slot*) data;
+  s->owner->release(s);
+}
+
+// ---
+
+gcore::DistributedRWLock::DistributedRWLock(size_t numSlots)
+  : mSlots(0), mMask(0), mWriter(0) {
+  if (numSlots == 0) {
+    numSlots = size_t(Thread::GetProcessorCount());
+  }
+  size_t n = 1;
+  while (n < numSlots) {
+    n <<= 1;
+  }
+  mMask = n - 1;
+  mSlots = new Slot[n];
+  for (size_t i=0; i<n; ++i) {
+    mSlots[i].readers.store(0, MO_RELAXED);
+  }
+}
+
+gcore::DistributedRWLock::~DistributedRWLock() {
+  delete[] mSlots;
+}
+
+size_t gcore::DistributedRWLock::currentSlot() const {
+#if defined(_WIN32) && (_WIN32_WINNT >= 0x0600)
+  return (size_t(GetCurrentProcessorNumber()) & mMask);
+#elif defined(__linux__)
+  int cpu = sched_getcpu();
+  if (cpu >= 0) {
+    return (size_t(cpu) & mMask);
+  }
+#endif
+  // spread threads using their ID
+  size_t h = (size_t) Thread::CurrentID();
+  h ^= (h >> 7) ^ (h >> 13);
+  return (h & mMask);
+}
+
+bool gcore::DistributedRWLock::drained() const {
+  for (size_t i=0; i<=mMask; ++i) {
+    if (mSlots[i].readers.load(MO_SEQ_CST) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool gcore::DistributedRWLock::tryReadLock(size_t &slot) {
+  slot = currentSlot();
+  // the counter update and the writer check must not be reordered
+  // (writeLock does the opposite)
+  mSlots[slot].readers.fetchAdd(1, MO_SEQ_CST);
+  if (mWriter.load(MO_SEQ_CST) == 0) {
+    return true;
+  }
+  mSlots[slot].readers.fetchSub(1, MO_RELEASE);
+  return false;
+}
+
+size_t gcore::DistributedRWLock::readLock() {
+  size_t slot = 0;
+  while (!tryReadLock(slot)) {
+    // wait for the writer to be done
+    mWriteAccess.lock();
+    mWriteAccess.unlock();
+  }
+  return slot;
+}
+
+void gcore::DistributedRWLock::readUnlock(size_t slot) {
+  mSlots[slot].readers.fetchSub(1, MO_RELEASE);
+}
+
+void gcore::DistributedRWLock::writeLock() {
+  mWriteAccess.lock();
+  mWriter.store(1, MO_SEQ_CST);
+  unsigned int spins = 0;
+  while (!drained()) {
+    if (++spins < 64) {
+      internal::CpuPause();
+    } else {
+      Thread::YieldCurrent();
+    }
+  }
+}
+
+bool gcore::DistributedRWLock::tryWriteLock() {
+  if (!mWriteAccess.tryLock()) {
+    return false;
+  }
+  mWriter.store(1, MO_SEQ_CST);
+  if (!drained()) {
+    mWriter.store(0, MO_RELEASE);
+    mWriteAccess.unlock();
+    return false;
+  }
+  return true;
+}
+
+void gcore::DistributedRWLock::writeUnlock() {
+  mWriter.store(0, MO_RELEASE);
+  mWriteAccess.unlock();
+}
+
+// ---
+
+gcore::Latch::Latch(size_t count, unsigned int spinCount)
+  : mCount(count), mSpinCount(Thread::GetProcessorCount() > 1 ? spinCount : 0) {
+}
+
+gcore::Latch::~Latch() {
+}
+
+void gcore::Latch::countDown(size_t n) {
+  size_t cur = mCount.load(MO_RELAXED);
+  do {
+    if (cur == 0) {
+      return;
+    }
+  } while (!mCount.compareExchange(cur, (n < cur ? cur - n : 0), MO_ACQ_REL));
+  if (n >= cur) {
+    // blocked waiters checked the count with the mutex held
+    mMutex.lock();
+    mReleased.notifyAll();
+    mMutex.unlock();
+  }
+}
+
+void gcore::Latch::arriveAndWait(size_t n) {
+  countDown(n);
+  wait();
+}
+
+bool gcore::Latch::tryWait() const {
+  return (mCount.load(MO_ACQUIRE) == 0);
+}
+
+bool gcore::Latch::spin() const {
+  for (unsigned int i=0; i<mSpinCount; ++i) {
+    if (mCount.load(MO_ACQUIRE) == 0) {
+      return true;
+    }
+    internal::CpuPause();
+  }
+  return (mCount.load(MO_ACQUIRE) == 0);
+}
+
+void gcore::Latch::wait() {
+  if (spin()) {
+    return;
+  }
+  mMutex.lock();
+  while (mCount.load(MO_ACQUIRE) != 0) {
+    mReleased.wait(mMutex);
+  }
+  mMutex.unlock();
+}
+
+bool gcore::Latch::timedWait(unsigned long msec) {
+  if (spin()) {
+    return true;
+  }
+  // wake ups don't restart the timeout
+  double deadline = Thread::MonotonicTime() + 0.001 * double(msec);
+  mMutex.lock();
+  while (mCount.load(MO_ACQUIRE) != 0) {
+    double remaining = deadline - Thread::MonotonicTime();
+    if (remaining <= 0.0) {
+      break;
+    }
+    mReleased.timedWait(mMutex, (unsigned long)(1000.0 * remaining) + 1);
+  }
+  mMutex.unlock();
+  return (mCount.load(MO_ACQUIRE) == 0);
+}
+
+// ---
+
+gcore::Barrier::Barrier(size_t count, unsigned int spinCount)
+  : mCount(count > 0 ? count : 1), mSpinCount(Thread::GetProcessorCount() > 1 ? spinCount : 0)
+  , mRemaining(count > 0 ? count : 1), mPhase(0) {
+}
+
+gcore::Barrier::~Barrier() {
+}
+
+bool gcore::Barrier::wait() {
+  // must be read before arriving: the last thread moves to the next phase
+  size_t phase = mPhase.load(MO_ACQUIRE);
+  
+  if (mRemaining.fetchSub(1, MO_ACQ_REL) == 1) {
+    // nobody can arrive for the next phase before it is published
+    mRemaining.store(mCount, MO_RELAXED);
+    mMutex.lock();
+    mPhase.store(phase + 1, MO_RELEASE);
+    mReleased.notifyAll();
+    mMutex.unlock();
+    return true;
+  }
+  
+  for (unsigned int i=0; i<mSpinCount; ++i) {
+    if (mPhase.load(MO_ACQUIRE) != phase) {
+      return false;
+    }
+    internal::CpuPause();
+  }
+  
+  mMutex.lock();
+  while (mPhase.load(MO_ACQUIRE) == phase) {
+    mReleased.wait(mMutex);
+  }
+  mMutex.unlock();
+  
+  return false;
+}
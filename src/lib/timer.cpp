@@ -0,0 +1,393 @@
+/*
+MIT License
+
+Copyright (c) 2009 Gaetan Guidet
+
+This file is part of gcore.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gcore/timer.h>
+#include <gcore/threadpool.h>
+#include <gcore/eventqueue.h>
+#include <gcore/platform.h>
+
+namespace gcore {
+
+const size_t TimerWheel::NoTimer = size_t(-1);
+
+TimerWheel::TimerWheel()
+  : mFree(NoTimer), mCount(0), mCurrent(0), mStart(0.0), mResolution(1)
+  , mRunning(false), mThreadRunning(false), mThread(0) {
+  for (size_t l=0; l<NumLevels; ++l) {
+    for (size_t s=0; s<NumSlots; ++s) {
+      mSlots[l][s] = NoTimer;
+    }
+  }
+}
+
+TimerWheel::~TimerWheel() {
+  stop();
+  // the thread may still be exiting after a stop from a timer callback
+  mAccess.lock();
+  deleteThread();
+  mAccess.unlock();
+}
+
+bool TimerWheel::start(unsigned long resolution) {
+  ScopeLock lock(mAccess);
+  
+  if (mRunning || mThreadRunning) {
+    return false;
+  }
+  
+  // left by a stop from a timer callback
+  deleteThread();
+  
+  mResolution = (resolution > 0 ? resolution : 1);
+  mStart = Thread::MonotonicTime();
+  mCurrent = 0;
+  mRunning = true;
+  mThreadRunning = true;
+  
+  mThread = new Thread(this, &TimerWheel::run, &TimerWheel::done);
+  
+  return true;
+}
+
+bool TimerWheel::stop() {
+  mAccess.lock();
+  
+  if (!mRunning) {
+    mAccess.unlock();
+    return false;
+  }
+  
+  mRunning = false;
+  mChanged.notifyAll();
+  
+  // from a timer callback the thread only exits once the callback returns,
+  // it is then deleted by the next start or the destructor
+  if (mThread == 0 || mThread->id() != Thread::CurrentID()) {
+    deleteThread();
+  }
+  
+  // cancel everything left
+  for (size_t l=0; l<NumLevels; ++l) {
+    for (size_t s=0; s<NumSlots; ++s) {
+      while (mSlots[l][s] != NoTimer) {
+        size_t index = mSlots[l][s];
+        unlink(index);
+        release(index);
+      }
+    }
+  }
+  
+  mAccess.unlock();
+  
+  return true;
+}
+
+void TimerWheel::deleteThread() {
+  if (mThread) {
+    while (mThreadRunning) {
+      mChanged.wait(mAccess);
+    }
+    delete mThread;
+    mThread = 0;
+  }
+}
+
+bool TimerWheel::running() {
+  ScopeLock lock(mAccess);
+  return mRunning;
+}
+
+size_t TimerWheel::numPending() {
+  ScopeLock lock(mAccess);
+  return mCount;
+}
+
+TimerID TimerWheel::schedule(Functor0 func, unsigned long delay, unsigned long period) {
+  return add(func, 0, 0, delay, period);
+}
+
+TimerID TimerWheel::schedule(Functor0 func, ThreadPool &pool, unsigned long delay, unsigned long period) {
+  return add(func, &pool, 0, delay, period);
+}
+
+TimerID TimerWheel::schedule(Functor0 func, EventQueue &queue, unsigned long delay, unsigned long period) {
+  return add(func, 0, &queue, delay, period);
+}
+
+bool TimerWheel::cancel(TimerID id) {
+  size_t index = size_t(id & 0xFFFFFFFF);
+  unsigned int generation = (unsigned int)(id >> 32);
+  
+  if (index == 0) {
+    return false;
+  }
+  
+  index -= 1;
+  
+  ScopeLock lock(mAccess);
+  
+  if (index >= mTimers.size()) {
+    return false;
+  }
+  
+  Timer &t = mTimers[index];
+  
+  if (!t.active || t.generation != generation) {
+    return false;
+  }
+  
+  unlink(index);
+  release(index);
+  
+  return true;
+}
+
+UInt64 TimerWheel::currentTick() const {
+  return UInt64(1000.0 * (Thread::MonotonicTime() - mStart) / double(mResolution));
+}
+
+TimerID TimerWheel::add(Functor0 func, ThreadPool *pool, EventQueue *queue, unsigned long delay, unsigned long period) {
+  
+  ScopeLock lock(mAccess);
+  
+  if (!mRunning || !func) {
+    return 0;
+  }
+  
+  size_t index = mFree;
+  
+  if (index != NoTimer) {
+    mFree = mTimers[index].next;
+  } else {
+    index = mTimers.size();
+    Timer t;
+    t.generation = 0;
+    mTimers.push_back(t);
+  }
+  
+  Timer &t = mTimers[index];
+  
+  // round delays up to the next tick, never fire early: part of the current
+  // tick has already elapsed, so it doesn't count towards the delay
+  UInt64 now = currentTick();
+  UInt64 ticks = (delay + mResolution - 1) / mResolution;
+  UInt64 expires = now + ticks + 1;
+  
+  if (mCount == 0 && now > mCurrent) {
+    // the wheel didn't turn while idle, catch up now rather than one tick
+    // at a time in the timer thread
+    mCurrent = now;
+  }
+  
+  t.func = func;
+  t.pool = pool;
+  t.queue = queue;
+  t.expires = (expires > mCurrent ? expires : mCurrent + 1);
+  t.period = (period + mResolution - 1) / mResolution;
+  t.active = true;
+  
+  insert(index);
+  
+  if (mCount++ == 0) {
+    // the timer thread sleeps while there is nothing to wait for
+    mChanged.notifyAll();
+  }
+  
+  return (TimerID(t.generation) << 32) | TimerID(index + 1);
+}
+
+void TimerWheel::insert(size_t index) {
+  Timer &t = mTimers[index];
+  
+  UInt64 delta = t.expires - mCurrent;
+  size_t level = 0;
+  
+  while (level+1 < NumLevels && delta >= (UInt64(1) << ((level + 1) * LevelBits))) {
+    ++level;
+  }
+  
+  UInt64 when = t.expires;
+  
+  if (level+1 == NumLevels && delta >= (UInt64(1) << (NumLevels * LevelBits))) {
+    // beyond the wheel range, parked as far as possible and re-inserted from there
+    when = mCurrent + (UInt64(1) << (NumLevels * LevelBits)) - 1;
+  }
+  
+  size_t slot = size_t(when >> (level * LevelBits)) & SlotMask;
+  size_t *head = &(mSlots[level][slot]);
+  
+  t.head = head;
+  t.prev = NoTimer;
+  t.next = *head;
+  if (*head != NoTimer) {
+    mTimers[*head].prev = index;
+  }
+  *head = index;
+}
+
+void TimerWheel::unlink(size_t index) {
+  Timer &t = mTimers[index];
+  
+  if (t.prev != NoTimer) {
+    mTimers[t.prev].next = t.next;
+  } else {
+    *(t.head) = t.next;
+  }
+  if (t.next != NoTimer) {
+    mTimers[t.next].prev = t.prev;
+  }
+  
+  t.head = 0;
+}
+
+void TimerWheel::release(size_t index) {
+  Timer &t = mTimers[index];
+  
+  t.func = Functor0();
+  t.active = false;
+  t.generation += 1;
+  t.next = mFree;
+  mFree = index;
+  
+  mCount -= 1;
+}
+
+void TimerWheel::cascade(size_t level, size_t slot) {
+  // timers move to lower levels as their expiration gets closer
+  size_t index = mSlots[level][slot];
+  
+  mSlots[level][slot] = NoTimer;
+  
+  while (index != NoTimer) {
+    size_t next = mTimers[index].next;
+    insert(index);
+    index = next;
+  }
+}
+
+void TimerWheel::advance(std::vector<Due> &due) {
+  
+  mCurrent += 1;
+  
+  if ((mCurrent & SlotMask) == 0) {
+    for (size_t level=1; level<NumLevels; ++level) {
+      size_t slot = size_t(mCurrent >> (level * LevelBits)) & SlotMask;
+      cascade(level, slot);
+      if (slot != 0) {
+        break;
+      }
+    }
+  }
+  
+  size_t index = mSlots[0][mCurrent & SlotMask];
+  
+  mSlots[0][mCurrent & SlotMask] = NoTimer;
+  
+  while (index != NoTimer) {
+    Timer &t = mTimers[index];
+    size_t next = t.next;
+    
+    if (t.expires > mCurrent) {
+      // was beyond the wheel range
+      insert(index);
+      
+    } else {
+      Due d = {t.func, t.pool, t.queue};
+      due.push_back(d);
+      
+      if (t.period > 0) {
+        t.expires = mCurrent + t.period;
+        insert(index);
+      } else {
+        t.head = 0;
+        release(index);
+      }
+    }
+    
+    index = next;
+  }
+}
+
+int TimerWheel::run() {
+  
+  std::vector<Due> due;
+  
+  mAccess.lock();
+  
+  while (mRunning) {
+    
+    UInt64 target = currentTick();
+    
+    if (mCount == 0) {
+      // nothing to fire, skip ahead
+      if (target > mCurrent) {
+        mCurrent = target;
+      }
+    } else {
+      while (mCurrent < target) {
+        advance(due);
+      }
+    }
+    
+    if (due.size() > 0) {
+      // callbacks may schedule or cancel timers
+      mAccess.unlock();
+      
+      for (size_t i=0; i<due.size(); ++i) {
+        Due &d = due[i];
+        if (d.pool) {
+          d.pool->runTask(d.func);
+        } else if (d.queue) {
+          d.queue->push(d.func, false);
+        } else {
+          d.func();
+        }
+      }
+      due.clear();
+      
+      mAccess.lock();
+      continue;
+    }
+    
+    if (mCount == 0) {
+      mChanged.wait(mAccess);
+    } else {
+      mChanged.timedWait(mAccess, mResolution);
+    }
+  }
+  
+  mAccess.unlock();
+  
+  return 0;
+}
+
+void TimerWheel::done(int) {
+  ScopeLock lock(mAccess);
+  mThreadRunning = false;
+  mChanged.notifyAll();
+}
+
+}
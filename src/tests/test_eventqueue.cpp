@@ -29,6 +29,7 @@ SOFTWARE.
 #include <gcore/threadpool.h>
 #include <gcore/eventqueue.h>
 #include <deque>
+#include <vector>
 #include <string>
 #include <iostream>
 #include <cstdarg>
@@ -207,6 +208,80 @@ void thread4Proc()
   gThread4Done = true;
 }
 
+EventQueue *gSharedQueue = 0;
+const int gBatchCount = 100;
+const int gBatchSize = 64;
+Atomic<int> gBatchEvents(0);
+Atomic<int> gBatchProducers(0);
+Atomic<int> gBatchConsumers(0);
+
+void batchEvent()
+{
+  ++gBatchEvents;
+}
+
+void batchProducerProc()
+{
+  std::vector<Event> evts(gBatchSize);
+  
+  for (int i=0; i<gBatchSize; ++i)
+  {
+    Bind(batchEvent, evts[i]);
+  }
+  
+  for (int i=0; i<gBatchCount; ++i)
+  {
+    gSharedQueue->push(evts);
+  }
+  
+  --gBatchProducers;
+}
+
+void batchConsumerProc()
+{
+  std::vector<Event> evts;
+  
+  while (gBatchProducers > 0 || gSharedQueue->poll(gBatchSize) > 0)
+  {
+    // mix both flavours of poll
+    evts.clear();
+    gSharedQueue->poll(16, evts);
+    for (size_t i=0; i<evts.size(); ++i)
+    {
+      evts[i]();
+    }
+  }
+  
+  --gBatchConsumers;
+}
+
+Atomic<int> gHandleWaiters(0);
+Atomic<int> gHandleFailures(0);
+
+void handleProc()
+{
+  std::vector<EventQueue::Handle> handles(gBatchSize);
+  Event func;
+  
+  Bind(batchEvent, func);
+  
+  for (int i=0; i<gBatchSize; ++i)
+  {
+    gSharedQueue->push(func, handles[i]);
+  }
+  
+  for (int i=gBatchSize-1; i>=0; --i)
+  {
+    handles[i].wait();
+    if (!handles[i].done())
+    {
+      ++gHandleFailures;
+    }
+  }
+  
+  --gHandleWaiters;
+}
+
 // If two threads send synchronized event, it seems the first one to be awake works fine
 // But the second one never awakes...
 
@@ -243,6 +318,60 @@ int main(int, char**)
   
   safePrint("Finished\n");
   
+  // batched push from several producers, polled by several consumers
+  EventQueue sharedQueue(true);
+  gSharedQueue = &sharedQueue;
+  gBatchProducers = 2;
+  gBatchConsumers = 2;
+  
+  Task producer, consumer;
+  
+  Bind(batchProducerProc, producer);
+  Bind(batchConsumerProc, consumer);
+  
+  tpool.runTask(producer);
+  tpool.runTask(producer);
+  tpool.runTask(consumer);
+  tpool.runTask(consumer);
+  
+  while (gBatchConsumers > 0)
+  {
+    sharedQueue.poll(gBatchSize);
+  }
+  sharedQueue.poll(gBatchCount * gBatchSize);
+  
+  safePrint("Batched events: %d/%d\n", int(gBatchEvents), 2 * gBatchCount * gBatchSize);
+  
+  if (gBatchEvents != 2 * gBatchCount * gBatchSize)
+  {
+    return 1;
+  }
+  
+  // each waiter only gets signaled by its own events
+  gBatchEvents = 0;
+  gHandleWaiters = 4;
+  
+  Task waiter;
+  
+  Bind(handleProc, waiter);
+  
+  for (int i=0; i<4; ++i)
+  {
+    tpool.runTask(waiter);
+  }
+  
+  while (gHandleWaiters > 0)
+  {
+    sharedQueue.poll(gBatchSize);
+  }
+  
+  safePrint("Waited events: %d/%d (%d failure(s))\n", int(gBatchEvents), 4 * gBatchSize, int(gHandleFailures));
+  
+  if (gBatchEvents != 4 * gBatchSize || gHandleFailures != 0)
+  {
+    return 1;
+  }
+  
   return 0;
 }
 
@@ -31,6 +31,10 @@ float add_float(float a, float b) {
   return a+b;
 }
 
+void print_range(const char *name, int from, int to) {
+  std::cout << name << ": [" << from << ", " << to << "[" << std::endl;
+}
+
 class Operator {
   public:
     Operator(){}
@@ -49,6 +53,17 @@ class Add : public Operator {
     }
 };
 
+class Scale {
+  public:
+    Scale(float s) : mScale(s) {
+    }
+    float apply(float offset, float v) const {
+      return offset + mScale * v;
+    }
+  private:
+    float mScale;
+};
+
 int main(int, char**) {
   
   Add add;
@@ -62,6 +77,23 @@ int main(int, char**) {
   std::cout << "Functor 0 result: " << cb0(1, 2) << std::endl;
   std::cout << "Functor 1 result: " << cb1(1, 2) << std::endl;
   
+  // bound arguments
+  Scale scale(2.0f);
+  
+  gcore::Functor0 cb2;
+  gcore::Functor1wR<float, float> cb3;
+  gcore::Functor0wR<float> cb4;
+  
+  gcore::Bind(print_range, "range", 0, 10, cb2);
+  gcore::Bind(add_float, 1.5f, cb3);
+  gcore::Bind(&scale, &Scale::apply, 1.0f, 3.0f, cb4);
+  
+  gcore::Functor0 cb5(cb2);
+  
+  cb5();
+  std::cout << "Functor 3 result: " << cb3(2) << std::endl;
+  std::cout << "Functor 4 result: " << cb4() << std::endl;
+  
   return 0;
 }
 
@@ -25,6 +25,7 @@ SOFTWARE.
 */
 
 #include <gcore/list.h>
+#include <gcore/threadpool.h>
 #include <cmath>
 
 struct Point {
@@ -106,6 +107,39 @@ int main(int, char**) {
   std::cout << "[-3] = " << points[-3] << std::endl;
   std::cout << "[" << idx << "] = " << points[idx] << std::endl;
   
-  return 0;
+  std::cout << "Parallel filter/map/reduce..." << std::endl;
+  gcore::ThreadPool pool(gcore::ThreadPool::SCH_WORK_STEALING);
+  pool.start();
+  
+  PointList big, big2;
+  for (size_t i=0; i<20000; ++i) {
+    big.push_back(Point(float(i % 5)));
+  }
+  big2 = big;
+  
+  big.filter(filter).map(normalize);
+  big2.parallelFilter(pool, filter).parallelMap(pool, normalize);
+  
+  bool same = (big.size() == big2.size());
+  for (size_t i=0; same && i<big.size(); ++i) {
+    same = (big[i].x == big2[i].x && big[i].y == big2[i].y && big[i].z == big2[i].z);
+  }
+  std::cout << big2.size() << " point(s) left, " << (same ? "same as" : "DIFFERENT from") << " serial version" << std::endl;
+  
+  // integral coordinates: sums are exact whatever the reduction order
+  PointList ints;
+  for (size_t i=0; i<20000; ++i) {
+    ints.push_back(Point(float(i % 5)));
+  }
+  
+  Point ssum = ints.reduce(sum);
+  Point psum = ints.parallelReduce(pool, sum, Point(), 64);
+  
+  bool sameSum = (ssum.x == psum.x && ssum.y == psum.y && ssum.z == psum.z);
+  std::cout << "Parallel sum: " << psum << ", serial sum: " << ssum << " (" << (sameSum ? "OK" : "FAILED") << ")" << std::endl;
+  
+  pool.stop();
+  
+  return ((same && sameSum) ? 0 : 1);
 }
 
@@ -0,0 +1,451 @@
+/*
+MIT License
+
+Copyright (c) 2009 Gaetan Guidet
+
+This file is part of gcore.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gcore/all.h>
+#include <gcore/platform.h>
+#include <vector>
+
+// Lock hand-off: all threads hammer the same very short critical section
+
+class Contention {
+  public:
+    
+    Contention(unsigned int spinCount, size_t numThreads, size_t total)
+      : mMutex(false, spinCount), mNumThreads(numThreads), mCount(total / numThreads), mValue(0) {
+    }
+    
+    int run() {
+      for (size_t i=0; i<mCount; ++i) {
+        mMutex.lock();
+        mValue += 1;
+        mMutex.unlock();
+      }
+      return 0;
+    }
+    
+    bool bench(const char *name) {
+      std::vector<gcore::Thread*> threads;
+      
+      double t0 = gcore::Thread::MonotonicTime();
+      for (size_t i=0; i<mNumThreads; ++i) {
+        threads.push_back(new gcore::Thread(this, &Contention::run));
+      }
+      for (size_t i=0; i<mNumThreads; ++i) {
+        threads[i]->join();
+        delete threads[i];
+      }
+      double t1 = gcore::Thread::MonotonicTime();
+      
+      bool ok = (mValue == mNumThreads * mCount);
+      fprintf(stdout, "  %s, %2lu thread(s): %8.1f ns/lock%s\n", name, (unsigned long)mNumThreads,
+              1000000000.0 * (t1 - t0) / double(mNumThreads * mCount), (ok ? "" : " [FAILED]"));
+      return ok;
+    }
+    
+  private:
+    
+    gcore::Mutex mMutex;
+    size_t mNumThreads;
+    size_t mCount;
+    size_t mValue;
+};
+
+// Wake-up latency: two threads passing a token back and forth
+
+class PingPong {
+  public:
+    
+    PingPong(size_t count)
+      : mCount(count), mTurn(0), mPing(true), mPong(true) {
+    }
+    
+    // SyncEvent version
+    
+    int pongEvent() {
+      for (size_t i=0; i<mCount; ++i) {
+        mPing.wait();
+        mPong.set();
+      }
+      return 0;
+    }
+    
+    double runEvent() {
+      gcore::Thread thr(this, &PingPong::pongEvent);
+      double t0 = gcore::Thread::MonotonicTime();
+      for (size_t i=0; i<mCount; ++i) {
+        mPing.set();
+        mPong.wait();
+      }
+      double t1 = gcore::Thread::MonotonicTime();
+      thr.join();
+      return (t1 - t0);
+    }
+    
+    // Mutex/Condition version
+    
+    void pass(int from, int to) {
+      mMutex.lock();
+      while (mTurn != from) {
+        mTurnChanged.wait(mMutex);
+      }
+      mTurn = to;
+      mTurnChanged.notify();
+      mMutex.unlock();
+    }
+    
+    int pongCondition() {
+      for (size_t i=0; i<mCount; ++i) {
+        pass(1, 0);
+      }
+      return 0;
+    }
+    
+    double runCondition() {
+      mTurn = 0;
+      gcore::Thread thr(this, &PingPong::pongCondition);
+      double t0 = gcore::Thread::MonotonicTime();
+      for (size_t i=0; i<mCount; ++i) {
+        pass(0, 1);
+      }
+      // wait for the last pong
+      mMutex.lock();
+      while (mTurn != 0) {
+        mTurnChanged.wait(mMutex);
+      }
+      mMutex.unlock();
+      double t1 = gcore::Thread::MonotonicTime();
+      thr.join();
+      return (t1 - t0);
+    }
+    
+  private:
+    
+    size_t mCount;
+    int mTurn;
+    gcore::Mutex mMutex;
+    gcore::Condition mTurnChanged;
+    gcore::SyncEvent mPing;
+    gcore::SyncEvent mPong;
+};
+
+// Read throughput: all threads read the same small value, one thread
+// occasionally updates it
+
+struct Pair {
+  size_t a;
+  size_t b;
+};
+
+class ReadMostly {
+  public:
+    
+    enum Kind {
+      RW_LOCK = 0,
+      DISTRIBUTED_RW_LOCK,
+      SEQ_LOCK
+    };
+    
+    ReadMostly(Kind kind, size_t numThreads, size_t total)
+      : mKind(kind), mNumThreads(numThreads), mCount(total / numThreads), mTorn(0), mDone(false) {
+      mPair.a = 0;
+      mPair.b = 0;
+    }
+    
+    Pair read() {
+      Pair p;
+      if (mKind == RW_LOCK) {
+        mRWLock.readLock();
+        p = mPair;
+        mRWLock.readUnlock();
+      } else if (mKind == DISTRIBUTED_RW_LOCK) {
+        size_t slot = mDistributedLock.readLock();
+        p = mPair;
+        mDistributedLock.readUnlock(slot);
+      } else {
+        p = mSeqPair.read();
+      }
+      return p;
+    }
+    
+    void write(size_t v) {
+      Pair p;
+      p.a = v;
+      p.b = v;
+      if (mKind == RW_LOCK) {
+        mRWLock.writeLock();
+        mPair = p;
+        mRWLock.writeUnlock();
+      } else if (mKind == DISTRIBUTED_RW_LOCK) {
+        mDistributedLock.writeLock();
+        mPair = p;
+        mDistributedLock.writeUnlock();
+      } else {
+        mSeqPair.write(p);
+      }
+    }
+    
+    int reader() {
+      size_t torn = 0;
+      for (size_t i=0; i<mCount; ++i) {
+        Pair p = read();
+        if (p.a != p.b) {
+          ++torn;
+        }
+      }
+      mTorn += torn;
+      return 0;
+    }
+    
+    int writer() {
+      size_t v = 0;
+      while (!mDone) {
+        write(++v);
+        gcore::Thread::SleepCurrent(1);
+      }
+      return 0;
+    }
+    
+    bool bench(const char *name) {
+      std::vector<gcore::Thread*> threads;
+      
+      mDone = false;
+      gcore::Thread wthr(this, &ReadMostly::writer);
+      
+      double t0 = gcore::Thread::MonotonicTime();
+      for (size_t i=0; i<mNumThreads; ++i) {
+        threads.push_back(new gcore::Thread(this, &ReadMostly::reader));
+      }
+      for (size_t i=0; i<mNumThreads; ++i) {
+        threads[i]->join();
+        delete threads[i];
+      }
+      double t1 = gcore::Thread::MonotonicTime();
+      
+      mDone = true;
+      wthr.join();
+      
+      bool ok = (mTorn == 0);
+      fprintf(stdout, "  %s, %2lu thread(s): %8.2f M reads/s%s\n", name, (unsigned long)mNumThreads,
+              double(mNumThreads * mCount) / (1000000.0 * (t1 - t0)), (ok ? "" : " [FAILED]"));
+      return ok;
+    }
+    
+  private:
+    
+    Kind mKind;
+    size_t mNumThreads;
+    size_t mCount;
+    gcore::Atomic<size_t> mTorn;
+    gcore::Atomic<bool> mDone;
+    Pair mPair;
+    gcore::RWLock mRWLock;
+    gcore::DistributedRWLock mDistributedLock;
+    gcore::SeqLocked<Pair> mSeqPair;
+};
+
+// Phase synchronization: threads go through a sequence of empty phases
+
+class Phases {
+  public:
+    
+    Phases(bool barrier, size_t numThreads, size_t numPhases)
+      : mUseBarrier(barrier), mNumThreads(numThreads), mNumPhases(numPhases)
+      , mBarrier(numThreads), mArrived(0), mPhase(0), mSerial(0), mErrors(0) {
+    }
+    
+    // what phased algorithms used to do
+    void rendezVous() {
+      mMutex.lock();
+      size_t phase = mPhase;
+      if (++mArrived == mNumThreads) {
+        mArrived = 0;
+        ++mPhase;
+        mSerial++;
+        mAllArrived.notifyAll();
+      } else {
+        while (mPhase == phase) {
+          mAllArrived.wait(mMutex);
+        }
+      }
+      mMutex.unlock();
+    }
+    
+    int run() {
+      for (size_t i=0; i<mNumPhases; ++i) {
+        if (mUseBarrier) {
+          if (mBarrier.wait()) {
+            mSerial++;
+          }
+          // nobody may be a phase ahead
+          if (mBarrier.phase() < i + 1) {
+            mErrors++;
+          }
+        } else {
+          rendezVous();
+        }
+      }
+      return 0;
+    }
+    
+    bool bench(const char *name) {
+      std::vector<gcore::Thread*> threads;
+      
+      double t0 = gcore::Thread::MonotonicTime();
+      for (size_t i=0; i<mNumThreads; ++i) {
+        threads.push_back(new gcore::Thread(this, &Phases::run));
+      }
+      for (size_t i=0; i<mNumThreads; ++i) {
+        threads[i]->join();
+        delete threads[i];
+      }
+      double t1 = gcore::Thread::MonotonicTime();
+      
+      bool ok = (mSerial == mNumPhases && mErrors == 0);
+      fprintf(stdout, "  %s, %2lu thread(s): %8.2f us/phase%s\n", name, (unsigned long)mNumThreads,
+              1000000.0 * (t1 - t0) / double(mNumPhases), (ok ? "" : " [FAILED]"));
+      return ok;
+    }
+    
+  private:
+    
+    bool mUseBarrier;
+    size_t mNumThreads;
+    size_t mNumPhases;
+    gcore::Barrier mBarrier;
+    gcore::Mutex mMutex;
+    gcore::Condition mAllArrived;
+    size_t mArrived;
+    size_t mPhase;
+    gcore::Atomic<size_t> mSerial;
+    gcore::Atomic<size_t> mErrors;
+};
+
+class CountDown {
+  public:
+    
+    CountDown(size_t numThreads)
+      : mNumThreads(numThreads), mStart(1), mDone(numThreads), mStarted(0) {
+    }
+    
+    int run() {
+      mStart.wait();
+      mStarted++;
+      mDone.countDown();
+      return 0;
+    }
+    
+    bool test() {
+      std::vector<gcore::Thread*> threads;
+      
+      for (size_t i=0; i<mNumThreads; ++i) {
+        threads.push_back(new gcore::Thread(this, &CountDown::run));
+      }
+      
+      bool ok = (!mDone.timedWait(10) && mStarted == 0);
+      
+      mStart.countDown();
+      mDone.wait();
+      ok = ok && mDone.tryWait() && mStarted == mNumThreads;
+      
+      for (size_t i=0; i<mNumThreads; ++i) {
+        threads[i]->join();
+        delete threads[i];
+      }
+      
+      return ok;
+    }
+    
+  private:
+    
+    size_t mNumThreads;
+    gcore::Latch mStart;
+    gcore::Latch mDone;
+    gcore::Atomic<size_t> mStarted;
+};
+
+bool TestSyncEvent() {
+  gcore::SyncEvent manual(false, false);
+  gcore::SyncEvent automatic(true, true);
+  
+  bool ok = !manual.timedWait(10);
+  manual.set();
+  ok = ok && manual.timedWait(10) && manual.isSet();
+  manual.reset();
+  ok = ok && !manual.isSet();
+  
+  // initially set, first wait consumes it
+  ok = ok && automatic.timedWait(10) && !automatic.timedWait(10);
+  
+  return ok;
+}
+
+int main(int, char**) {
+  bool ok = true;
+  size_t total = 400000;
+  
+  fprintf(stdout, "Mutex hand-off...\n");
+  
+  for (size_t nt=2; nt<=64; nt*=2) {
+    ok = Contention(0, nt, total).bench("blocking") && ok;
+    ok = Contention(gcore::Mutex::AdaptiveSpinCount, nt, total).bench("adaptive") && ok;
+  }
+  
+  fprintf(stdout, "Read throughput...\n");
+  
+  for (size_t nt=1; nt<=64; nt*=2) {
+    ok = ReadMostly(ReadMostly::RW_LOCK, nt, 4 * total).bench("rwlock     ") && ok;
+    ok = ReadMostly(ReadMostly::DISTRIBUTED_RW_LOCK, nt, 4 * total).bench("distributed") && ok;
+    ok = ReadMostly(ReadMostly::SEQ_LOCK, nt, 4 * total).bench("seqlock    ") && ok;
+  }
+  
+  fprintf(stdout, "Phase synchronization...\n");
+  
+  if (!CountDown(8).test()) {
+    fprintf(stdout, "  latch [FAILED]\n");
+    ok = false;
+  }
+  
+  for (size_t nt=2; nt<=64; nt*=2) {
+    ok = Phases(false, nt, 2000).bench("mutex + condition") && ok;
+    ok = Phases(true, nt, 2000).bench("barrier          ") && ok;
+  }
+  
+  fprintf(stdout, "Wake-up latency...\n");
+  
+  if (!TestSyncEvent()) {
+    fprintf(stdout, "  sync event [FAILED]\n");
+    ok = false;
+  }
+  
+  size_t count = 20000;
+  PingPong pp(count);
+  fprintf(stdout, "  sync event       : %8.2f us/round trip\n", 1000000.0 * pp.runEvent() / double(count));
+  fprintf(stdout, "  mutex + condition: %8.2f us/round trip\n", 1000000.0 * pp.runCondition() / double(count));
+  
+  fprintf(stdout, "%s\n", (ok ? "OK" : "FAILED"));
+  
+  return (ok ? 0 : 1);
+}
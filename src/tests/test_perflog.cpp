@@ -26,6 +26,8 @@ SOFTWARE.
 
 #include <gcore/perflog.h>
 #include <gcore/log.h>
+#include <gcore/threadpool.h>
+#include <gcore/platform.h>
 #include <cstdio>
 #include <cstring>
 
@@ -78,6 +80,285 @@ void FuncA(unsigned long n)
    FuncC(n >> 2);
 }
 
+void RunFuncA(unsigned long n)
+{
+   FuncA(n);
+}
+
+// tasks log in their worker thread log, merged for printing
+bool TestThreads(unsigned long n)
+{
+   const size_t numTasks = 200;
+   
+   PerfLog::Clear();
+   
+   ThreadPool pool;
+   Task task;
+   
+   Bind(RunFuncA, n, task);
+   
+   pool.start(4);
+   
+   for (size_t i=0; i<numTasks; ++i)
+   {
+      pool.runTask(task);
+   }
+   
+   pool.wait();
+   
+   // workers are still alive
+   PerfLog live;
+   PerfLog::Snapshot(live);
+   
+   pool.stop();
+   
+   // workers logs were retired
+   PerfLog retired;
+   PerfLog::Snapshot(retired);
+   
+   PerfLog::BaseEntryMap::const_iterator lit = live.entries().find("FuncD");
+   PerfLog::BaseEntryMap::const_iterator rit = retired.entries().find("FuncD");
+   
+   bool ok = (lit != live.entries().end() && lit->second.callCount == 2 * numTasks &&
+              rit != retired.entries().end() && rit->second.callCount == 2 * numTasks &&
+              live.rootEntries().size() == 1);
+   
+   fprintf(stdout, "Threads: FuncD called %lu/%lu time(s) (%s)\n",
+           (unsigned long)(rit != retired.entries().end() ? rit->second.callCount : 0),
+           (unsigned long)(2 * numTasks), (ok ? "OK" : "FAILED"));
+   
+   PerfLog::Clear();
+   
+   return ok;
+}
+
+// timeline of the tasks scopes across workers
+bool TestTrace(unsigned long n)
+{
+   const size_t numTasks = 20;
+   
+   PerfLog::Clear();
+   PerfLog::RecordEvents(256);
+   
+   ThreadPool pool;
+   Task task;
+   
+   Bind(RunFuncA, n, task);
+   
+   pool.start(4);
+   
+   for (size_t i=0; i<numTasks; ++i)
+   {
+      pool.runTask(task);
+   }
+   
+   pool.wait();
+   pool.stop();
+   
+   PerfLog::EventList events;
+   PerfLog::Events(events);
+   
+   // FuncA, FuncB, FuncD, FuncE, FuncC, FuncD per task
+   bool ok = (events.size() == 6 * numTasks);
+   
+   for (size_t i=0; ok && i<events.size(); ++i)
+   {
+      ok = (events[i].thread > 0 && events[i].duration >= 0.0 &&
+            (events[i].id == "FuncA") == (events[i].depth == 0));
+   }
+   
+   std::ostringstream trace;
+   PerfLog::WriteChromeTrace(trace);
+   
+   size_t numX = 0;
+   size_t pos = trace.str().find("\"ph\":\"X\"");
+   while (pos != std::string::npos)
+   {
+      ++numX;
+      pos = trace.str().find("\"ph\":\"X\"", pos + 1);
+   }
+   
+   std::ostringstream folded;
+   PerfLog::WriteFoldedStacks(folded);
+   
+   ok = (ok && numX == events.size() && trace.str().find("{\"traceEvents\":[") == 0 &&
+         folded.str().find("FuncA;FuncB;FuncE ") != std::string::npos);
+   
+   fprintf(stdout, "Trace: %lu event(s), %lu trace event(s) (%s)\n",
+           (unsigned long)events.size(), (unsigned long)numX, (ok ? "OK" : "FAILED"));
+   
+   PerfLog::RecordEvents(0);
+   PerfLog::Clear();
+   
+   return ok;
+}
+
+void NamedScopes(size_t count)
+{
+   for (size_t i=0; i<count; ++i)
+   {
+      ScopedPerfLog outer("Overhead.outer");
+      {
+         ScopedPerfLog inner("Overhead.inner");
+      }
+   }
+}
+
+void ProbeScopes(size_t count)
+{
+   for (size_t i=0; i<count; ++i)
+   {
+      GCORE_PERFLOG_SCOPE("Overhead.outer");
+      {
+         GCORE_PERFLOG_SCOPE("Overhead.inner");
+      }
+   }
+}
+
+// cost of a begin/end pair, by name and through probes
+bool TestOverhead(size_t count)
+{
+   PerfLog::Clear();
+   
+   double t0 = Thread::MonotonicTime();
+   NamedScopes(count);
+   double t1 = Thread::MonotonicTime();
+   ProbeScopes(count);
+   double t2 = Thread::MonotonicTime();
+   
+   // both paths must land in the same entries
+   PerfLog plog;
+   PerfLog::Snapshot(plog);
+   
+   PerfLog::EntryMap::const_iterator it = plog.rootEntries().find("Overhead.outer");
+   
+   bool ok = (it != plog.rootEntries().end() && it->second.callCount == 2 * count &&
+              it->second.subs.size() == 1 && it->second.subs.begin()->second.callCount == 2 * count);
+   
+   fprintf(stdout, "Overhead: %.1f ns/scope by name, %.1f ns/scope with probes (%s)\n",
+           1000000000.0 * (t1 - t0) / double(2 * count),
+           1000000000.0 * (t2 - t1) / double(2 * count), (ok ? "OK" : "FAILED"));
+   
+   PerfLog::Clear();
+   
+   return ok;
+}
+
+// busy scope timed by the current clock source against the wall clock
+bool TestClock(const char *name, size_t count)
+{
+   PerfLog::Clear();
+   
+   volatile double rv = 0.0;
+   
+   double t0 = Thread::MonotonicTime();
+   {
+      ScopedPerfLog scope("Clock.busy");
+      rv = SpendTime(20000000);
+   }
+   (void) rv;
+   double t1 = Thread::MonotonicTime();
+   ProbeScopes(count);
+   double t2 = Thread::MonotonicTime();
+   
+   PerfLog plog;
+   PerfLog::Snapshot(plog);
+   
+   PerfLog::BaseEntryMap::const_iterator it = plog.entries().find("Clock.busy");
+   
+   double measured = (it != plog.entries().end() ? it->second.totalTime : 0.0);
+   double actual = t1 - t0;
+   
+   bool ok = (measured >= 0.75 * actual && measured <= 1.25 * actual);
+   
+   fprintf(stdout, "%s clock: %.1f ms measured for %.1f ms, %.1f ns/scope with probes (%s)\n",
+           name, 1000.0 * measured, 1000.0 * actual,
+           1000000000.0 * (t2 - t1) / double(2 * count), (ok ? "OK" : "FAILED"));
+   
+   PerfLog::Clear();
+   
+   return ok;
+}
+
+bool TestClocks(size_t count)
+{
+   if (!TestClock("Default", count))
+   {
+      return false;
+   }
+   
+   if (!PerfLog::SetClockSource(PerfLog::TSCClock))
+   {
+      fprintf(stdout, "TSC clock: not available (skipped)\n");
+      return true;
+   }
+   
+   fprintf(stdout, "TSC clock: %.1f MHz\n", PerfLog::TicksPerSecond() / 1000000.0);
+   
+   bool ok = TestClock("TSC", count);
+   
+   // not while a scope is open, it would end on the other clock
+   bool refused = false;
+   {
+      ScopedPerfLog scope("Clock.open");
+      refused = !PerfLog::SetClockSource(PerfLog::DefaultClock);
+   }
+   bool switched = PerfLog::SetClockSource(PerfLog::DefaultClock);
+   
+   fprintf(stdout, "Clock switch: %s with an open scope, %s after (%s)\n",
+           (refused ? "refused" : "accepted"), (switched ? "accepted" : "refused"),
+           (refused && switched ? "OK" : "FAILED"));
+   
+   return (ok && refused && switched);
+}
+
+static bool Near(double val, double ref)
+{
+   // histogram buckets are 1/8th of a power of 2 wide
+   return (val >= ref * 0.875 && val <= ref * 1.125);
+}
+
+// percentiles of calls durations, after a merge
+bool TestPercentiles()
+{
+   PerfLog plog0(PerfLog::MilliSeconds);
+   PerfLog plog1(PerfLog::MilliSeconds);
+   
+   plog0.add("Latency", 98.0, 98, PerfLog::MilliSeconds);
+   plog1.add("Latency", 100.0, 1, PerfLog::MilliSeconds);
+   plog1.add("Latency", 0.5, 1, PerfLog::MilliSeconds);
+   
+   plog0.merge(plog1);
+   
+   PerfLog::BaseEntryMap::const_iterator it = plog0.entries().find("Latency");
+   
+   bool ok = (it != plog0.entries().end());
+   
+   if (ok)
+   {
+      const PerfLog::Histogram &h = it->second.durations;
+      
+      ok = (h.count() == 100 &&
+            Near(h.percentile(0.0), 500000.0) &&
+            Near(h.percentile(0.5), 1000000.0) &&
+            Near(h.percentile(0.9), 1000000.0) &&
+            Near(h.percentile(0.99), 1000000.0) &&
+            Near(h.percentile(1.0), 100000000.0) &&
+            h.max() == 100000000.0);
+      
+      fprintf(stdout, "Percentiles: p50=%f p90=%f p99=%f max=%f ms (%s)\n",
+              PerfLog::ConvertUnits(h.percentile(0.5), PerfLog::NanoSeconds, PerfLog::MilliSeconds),
+              PerfLog::ConvertUnits(h.percentile(0.9), PerfLog::NanoSeconds, PerfLog::MilliSeconds),
+              PerfLog::ConvertUnits(h.percentile(0.99), PerfLog::NanoSeconds, PerfLog::MilliSeconds),
+              PerfLog::ConvertUnits(h.max(), PerfLog::NanoSeconds, PerfLog::MilliSeconds),
+              (ok ? "OK" : "FAILED"));
+   }
+   
+   plog0.print(std::cout, PerfLog::ShowPercentiles, PerfLog::SortP99);
+   
+   return ok;
+}
+
 int main(int argc, char **argv)
 {
    unsigned long loop = 10;
@@ -101,6 +382,11 @@ int main(int argc, char **argv)
       }
    }
    
+   if (!TestThreads(n) || !TestTrace(20 * n) || !TestOverhead(200000) || !TestPercentiles() || !TestClocks(200000))
+   {
+      return 1;
+   }
+   
    LOG_PERF("Top");
    
    for (unsigned long i=0; i<loop; ++i)
@@ -0,0 +1,225 @@
+/*
+MIT License
+
+Copyright (c) 2009 Gaetan Guidet
+
+This file is part of gcore.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gcore/all.h>
+#include <gcore/platform.h>
+#include <vector>
+
+struct Item {
+  size_t index;
+  size_t value;
+};
+
+class Job {
+  public:
+    
+    Job(size_t count, unsigned long ioDelay=0, unsigned long cpuDelay=0)
+      : mCount(count), mIODelay(ioDelay), mCPUDelay(cpuDelay), mNext(0)
+      , mInFlight(0), mPeak(0), mLastIndex(0), mOrdered(true), mSum(0), mWritten(0) {
+    }
+    
+    // read
+    void* read(void *) {
+      if (mNext >= mCount) {
+        return 0;
+      }
+      if (mIODelay > 0) {
+        gcore::Thread::SleepCurrent(mIODelay);
+      }
+      Item *item = new Item();
+      item->index = mNext++;
+      item->value = item->index;
+      size_t n = ++mInFlight;
+      size_t peak = mPeak;
+      while (n > peak && !mPeak.compareExchange(peak, n)) {}
+      return item;
+    }
+    
+    // parse
+    void* square(void *data) {
+      Item *item = (Item*) data;
+      if (mCPUDelay > 0) {
+        gcore::Thread::SleepCurrent(mCPUDelay);
+      }
+      item->value = item->value * item->value;
+      return item;
+    }
+    
+    // transform, drops every third item
+    void* filter(void *data) {
+      Item *item = (Item*) data;
+      if (item->index % 3 == 0) {
+        delete item;
+        --mInFlight;
+        return 0;
+      }
+      return item;
+    }
+    
+    // must see the items in input order
+    void* check(void *data) {
+      Item *item = (Item*) data;
+      if (mSum > 0 && item->index <= mLastIndex) {
+        mOrdered = false;
+      }
+      mLastIndex = item->index;
+      mSum += item->value;
+      return item;
+    }
+    
+    // write
+    void* write(void *data) {
+      Item *item = (Item*) data;
+      ++mWritten;
+      --mInFlight;
+      delete item;
+      return 0;
+    }
+    
+    void setup(gcore::Pipeline &pipeline) {
+      gcore::StageFunc func;
+      
+      pipeline.clear();
+      
+      gcore::Bind(this, &Job::read, func);
+      pipeline.input(func);
+      
+      gcore::Bind(this, &Job::square, func);
+      pipeline.addStage(func, gcore::Pipeline::SM_PARALLEL);
+      
+      gcore::Bind(this, &Job::filter, func);
+      pipeline.addStage(func, gcore::Pipeline::SM_PARALLEL);
+      
+      gcore::Bind(this, &Job::check, func);
+      pipeline.addStage(func, gcore::Pipeline::SM_SERIAL_IN_ORDER);
+      
+      gcore::Bind(this, &Job::write, func);
+      pipeline.addStage(func, gcore::Pipeline::SM_SERIAL_OUT_OF_ORDER);
+    }
+    
+    size_t expectedSum() const {
+      size_t sum = 0;
+      for (size_t i=0; i<mCount; ++i) {
+        if (i % 3 != 0) {
+          sum += i * i;
+        }
+      }
+      return sum;
+    }
+    
+    size_t expectedWrites() const {
+      return (mCount - (mCount + 2) / 3);
+    }
+    
+    bool check(size_t read, size_t maxItems) const {
+      return (read == mCount && mOrdered && mSum == expectedSum() &&
+              mWritten == expectedWrites() && mInFlight == 0 && mPeak <= maxItems);
+    }
+    
+    size_t peak() const {
+      return mPeak;
+    }
+    
+  private:
+    
+    size_t mCount;
+    unsigned long mIODelay;
+    unsigned long mCPUDelay;
+    size_t mNext;
+    gcore::Atomic<size_t> mInFlight;
+    gcore::Atomic<size_t> mPeak;
+    size_t mLastIndex;
+    bool mOrdered;
+    size_t mSum;
+    size_t mWritten;
+};
+
+bool TestOrdering(gcore::ThreadPool &pool, size_t maxItems) {
+  Job job(20000);
+  gcore::Pipeline pipeline(pool);
+  
+  job.setup(pipeline);
+  
+  double t0 = gcore::Thread::MonotonicTime();
+  size_t read = pipeline.run(maxItems);
+  double t1 = gcore::Thread::MonotonicTime();
+  
+  bool ok = job.check(read, maxItems);
+  
+  fprintf(stdout, "%lu items, %2lu in flight (peak %lu): %.2f us/item (%s)\n",
+          (unsigned long)read, (unsigned long)maxItems, (unsigned long)job.peak(),
+          1000000.0 * (t1 - t0) / double(read > 0 ? read : 1), (ok ? "OK" : "FAILED"));
+  
+  return ok;
+}
+
+// reading and processing overlap (sleeps stand for I/O and computation)
+bool TestOverlap(gcore::ThreadPool &pool) {
+  size_t count = 100;
+  Job job(count, 2, 4);
+  gcore::Pipeline pipeline(pool);
+  
+  job.setup(pipeline);
+  
+  double t0 = gcore::Thread::MonotonicTime();
+  size_t read = pipeline.run(8);
+  double t1 = gcore::Thread::MonotonicTime();
+  
+  // 6ms per item when run sequentially, the input is the bottleneck
+  double sequential = 0.006 * double(count);
+  bool ok = (job.check(read, 8) && (t1 - t0) < 0.75 * sequential);
+  
+  fprintf(stdout, "Overlap: %.0fms (sequential %.0fms) (%s)\n",
+          1000.0 * (t1 - t0), 1000.0 * sequential, (ok ? "OK" : "FAILED"));
+  
+  return ok;
+}
+
+int main(int, char**) {
+  bool ok = true;
+  
+  gcore::ThreadPool stopped;
+  
+  fprintf(stdout, "No pool workers: ");
+  ok = TestOrdering(stopped, 16) && ok;
+  
+  for (int s=0; s<2; ++s) {
+    gcore::ThreadPool pool(s == 0 ? gcore::ThreadPool::SCH_SHARED_QUEUE : gcore::ThreadPool::SCH_WORK_STEALING);
+    pool.start(4);
+    
+    fprintf(stdout, "%s\n", (s == 0 ? "Shared queue..." : "Work stealing..."));
+    
+    for (size_t n=1; n<=64; n*=4) {
+      ok = TestOrdering(pool, n) && ok;
+    }
+    
+    ok = TestOverlap(pool) && ok;
+    
+    pool.stop();
+  }
+  
+  return (ok ? 0 : 1);
+}
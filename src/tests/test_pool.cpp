@@ -25,6 +25,7 @@ SOFTWARE.
 */
 
 #include <gcore/all.h>
+#include <gcore/platform.h>
 #include <cmath>
 #include <cstdarg>
 
@@ -84,7 +85,514 @@ void ComputeFunc(char c, int i) {
 }
 
 
-int main(int, char**) {
+volatile float gSink = 0.0f;
+
+void TinyTask() {
+  float sum = 0.0f;
+  for (int j=0; j<50; ++j) {
+    sum += float(j) * 0.5f;
+  }
+  gSink = sum;
+}
+
+void Benchmark(gcore::ThreadPool::Scheduling sched, size_t numThreads, size_t numTasks) {
+  gcore::Task task;
+  gcore::Bind(TinyTask, task);
+  
+  gcore::ThreadPool pool(sched);
+  pool.start(numThreads);
+  
+  double t0 = gcore::Thread::MonotonicTime();
+  for (size_t i=0; i<numTasks; ++i) {
+    pool.runTask(task);
+  }
+  pool.wait();
+  double t1 = gcore::Thread::MonotonicTime();
+  
+  pool.stop();
+  
+  safe_print("  %s, %2lu thread(s): %12.0f tasks/sec\n",
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue "),
+             (unsigned long)numThreads, double(numTasks) / (t1 - t0));
+}
+
+// fork/join: each task splits its range in two child tasks until small enough
+
+gcore::Mutex gSumAccess;
+unsigned long gSum = 0;
+
+class RangeSum {
+  public:
+    
+    RangeSum(unsigned long from, unsigned long to)
+      : mFrom(from), mTo(to) {
+    }
+    
+    void run() {
+      if (mTo - mFrom <= 100) {
+        unsigned long sum = 0;
+        for (unsigned long i=mFrom; i<mTo; ++i) {
+          sum += i;
+        }
+        gSumAccess.lock();
+        gSum += sum;
+        gSumAccess.unlock();
+      } else {
+        unsigned long mid = mFrom + (mTo - mFrom) / 2;
+        Submit(new RangeSum(mFrom, mid));
+        Submit(new RangeSum(mid, mTo));
+      }
+      delete this;
+    }
+    
+    static void Submit(RangeSum *rs) {
+      gcore::Task task;
+      gcore::Bind(rs, &RangeSum::run, task);
+      gcore::ThreadPool::Current()->runTask(task);
+    }
+    
+  private:
+    
+    unsigned long mFrom;
+    unsigned long mTo;
+};
+
+class Submitter {
+  public:
+    
+    Submitter(gcore::ThreadPool *pool, unsigned long from, unsigned long to)
+      : mPool(pool), mFrom(from), mTo(to) {
+    }
+    
+    int run() {
+      // submit from a thread that is neither the driver nor a worker
+      gcore::Task task;
+      gcore::Bind(new RangeSum(mFrom, mTo), &RangeSum::run, task);
+      return (mPool->runTask(task) ? 0 : 1);
+    }
+    
+  private:
+    
+    gcore::ThreadPool *mPool;
+    unsigned long mFrom;
+    unsigned long mTo;
+};
+
+void RunForkJoin(gcore::ThreadPool::Scheduling sched) {
+  gcore::ThreadPool pool(sched);
+  
+  pool.start(4);
+  
+  gSum = 0;
+  
+  Submitter s0(&pool, 0, 30000);
+  Submitter s1(&pool, 30000, 60000);
+  
+  gcore::Thread thr0(&s0, &Submitter::run);
+  gcore::Thread thr1(&s1, &Submitter::run);
+  thr0.join();
+  thr1.join();
+  
+  pool.wait();
+  pool.stop();
+  
+  unsigned long expected = (59999UL * 60000UL) / 2;
+  
+  safe_print("Fork/join sum (%s): %lu (%s)\n",
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue"),
+             gSum, (gSum == expected ? "OK" : "FAILED"));
+}
+
+// nested task groups: each task waits for its children (helping meanwhile)
+
+class JoinSum {
+  public:
+    
+    JoinSum(unsigned long from, unsigned long to)
+      : mFrom(from), mTo(to), mSum(0) {
+    }
+    
+    void run() {
+      if (mTo - mFrom <= 100) {
+        for (unsigned long i=mFrom; i<mTo; ++i) {
+          mSum += i;
+        }
+      } else {
+        unsigned long mid = mFrom + (mTo - mFrom) / 2;
+        JoinSum left(mFrom, mid);
+        JoinSum right(mid, mTo);
+        gcore::Task task;
+        gcore::TaskGroup group(*gcore::ThreadPool::Current());
+        gcore::Bind(&left, &JoinSum::run, task);
+        group.run(task);
+        gcore::Bind(&right, &JoinSum::run, task);
+        group.run(task);
+        group.wait();
+        mSum = left.mSum + right.mSum;
+      }
+    }
+    
+    inline unsigned long sum() const {
+      return mSum;
+    }
+    
+  private:
+    
+    unsigned long mFrom;
+    unsigned long mTo;
+    unsigned long mSum;
+};
+
+void SlowTask() {
+  gcore::Thread::SleepCurrent(200);
+}
+
+void RunTaskGroups(gcore::ThreadPool::Scheduling sched) {
+  gcore::ThreadPool pool(sched);
+  gcore::Task task;
+  
+  pool.start(2);
+  
+  // background tasks that the groups below shouldn't have to wait for
+  gcore::TaskGroup background(pool);
+  gcore::Bind(SlowTask, task);
+  background.run(task);
+  background.run(task);
+  
+  JoinSum js0(0, 30000);
+  JoinSum js1(30000, 60000);
+  gcore::TaskGroup group(pool);
+  gcore::Bind(&js0, &JoinSum::run, task);
+  group.run(task);
+  gcore::Bind(&js1, &JoinSum::run, task);
+  group.run(task);
+  group.wait();
+  
+  unsigned long expected = (59999UL * 60000UL) / 2;
+  unsigned long sum = js0.sum() + js1.sum();
+  
+  safe_print("Task group sum (%s): %lu (%s)\n",
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue"),
+             sum, (sum == expected ? "OK" : "FAILED"));
+  
+  background.wait();
+  pool.stop();
+}
+
+// futures
+
+int SlowAnswer() {
+  gcore::Thread::SleepCurrent(100);
+  return 42;
+}
+
+double Half(int v) {
+  return 0.5 * double(v);
+}
+
+std::string Describe(double v) {
+  std::ostringstream oss;
+  oss << "half of the answer is " << v;
+  return oss.str();
+}
+
+void RunFutures(gcore::ThreadPool::Scheduling sched) {
+  gcore::ThreadPool pool(sched);
+  
+  pool.start(2);
+  
+  gcore::Functor0wR<int> answer;
+  gcore::Functor1wR<double, int> half;
+  gcore::Functor1wR<std::string, double> describe;
+  
+  gcore::Bind(SlowAnswer, answer);
+  gcore::Bind(Half, half);
+  gcore::Bind(Describe, describe);
+  
+  gcore::Future<int> f0 = pool.submit(answer);
+  gcore::Future<std::string> f1 = f0.then(half).then(describe);
+  
+  int val = 0;
+  bool early = f0.tryGet(val);
+  bool timedout = !f0.timedWait(1);
+  
+  safe_print("Futures (%s): tryGet %s, timedWait %s, get %d, then \"%s\"\n",
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue"),
+             (early ? "ready" : "not ready"), (timedout ? "timed out" : "ready"),
+             f0.get(), f1.get().c_str());
+  
+  pool.stop();
+}
+
+// placement: pinned workers, tasks submitted to every node
+
+void RunPlacement(gcore::ThreadPool::Scheduling sched, gcore::ThreadPool::Placement placement) {
+  static const char *names[] = {"none", "compact", "scatter", "numa nodes"};
+  
+  gcore::ThreadPool pool(sched);
+  
+  pool.placement(placement);
+  pool.start(4);
+  
+  gSum = 0;
+  
+  size_t nn = pool.numNodes();
+  
+  for (unsigned long i=0; i<8; ++i) {
+    gcore::Task task;
+    gcore::Bind(new RangeSum(i * 10000, (i + 1) * 10000), &RangeSum::run, task);
+    pool.runTaskOnNode(size_t(i) % nn, task);
+  }
+  
+  pool.wait();
+  pool.stop();
+  
+  unsigned long expected = (79999UL * 80000UL) / 2;
+  
+  safe_print("Placement %s (%s): %lu node(s), sum %lu (%s)\n",
+             names[placement],
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue"),
+             nn, gSum, (gSum == expected ? "OK" : "FAILED"));
+}
+
+// priorities: a single worker is blocked while lanes are filled
+
+gcore::Mutex gOrderAccess;
+std::vector<int> gOrder;
+
+void RecordTask(int id) {
+  gOrderAccess.lock();
+  gOrder.push_back(id);
+  gOrderAccess.unlock();
+}
+
+void BlockTask(gcore::SyncEvent *ev) {
+  ev->wait();
+}
+
+void RunPriorities(gcore::ThreadPool::Scheduling sched) {
+  gcore::ThreadPool pool(sched);
+  gcore::SyncEvent gate;
+  gcore::Task task;
+  
+  pool.starvationLimit(4);
+  pool.start(1);
+  
+  gOrder.clear();
+  
+  gcore::Bind(BlockTask, &gate, task);
+  pool.runTask(task, gcore::ThreadPool::PRI_HIGH);
+  
+  // let the worker pick the blocking task
+  while (pool.numPendingTasks() > 0) {
+    gcore::Thread::SleepCurrent(1);
+  }
+  
+  // ids: low 0-19, high 100-109, deadline 200-204 (submitted latest first)
+  for (int i=0; i<20; ++i) {
+    gcore::Bind(RecordTask, i, task);
+    pool.runTask(task, gcore::ThreadPool::PRI_LOW);
+  }
+  for (int i=0; i<10; ++i) {
+    gcore::Bind(RecordTask, 100+i, task);
+    pool.runTask(task, gcore::ThreadPool::PRI_HIGH);
+  }
+  for (int i=0; i<5; ++i) {
+    gcore::Bind(RecordTask, 204-i, task);
+    pool.runTask(task, gcore::ThreadPool::PRI_NORMAL, 1000 + 100 * (5-i));
+  }
+  
+  gcore::ThreadPool::QueueStats low = pool.queueStats(gcore::ThreadPool::PRI_LOW);
+  size_t pendingLow = low.pending;
+  
+  gate.set();
+  pool.wait();
+  
+  low = pool.queueStats(gcore::ThreadPool::PRI_LOW);
+  
+  pool.stop();
+  
+  // each lane in order, low tasks before the last other task only let in by
+  // the starvation protection
+  bool ordered = (gOrder.size() == 35);
+  int nextHigh = 100, nextDeadline = 200, nextLow = 0;
+  size_t early = 0, lows = 0;
+  
+  for (size_t i=0; ordered && i<gOrder.size(); ++i) {
+    int id = gOrder[i];
+    if (id >= 200) {
+      ordered = (id == nextDeadline++);
+      early = lows;
+    } else if (id >= 100) {
+      ordered = (id == nextHigh++);
+      early = lows;
+    } else {
+      ordered = (id == nextLow++);
+      lows += 1;
+    }
+  }
+  
+  safe_print("Priorities (%s): %lu low pending, %lu run early, %lu promoted (%s)\n",
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue"),
+             pendingLow, early, low.promoted,
+             (ordered && early == low.promoted && low.queued == 20 && low.peak == 20 ? "OK" : "FAILED"));
+}
+
+// elastic: blocking tasks make the pool grow, idle workers retire
+
+gcore::Mutex gBusyAccess;
+size_t gBusy = 0;
+size_t gMaxBusy = 0;
+
+void BlockingTask() {
+  gBusyAccess.lock();
+  gBusy += 1;
+  if (gBusy > gMaxBusy) {
+    gMaxBusy = gBusy;
+  }
+  gBusyAccess.unlock();
+  
+  // waiting on I/O
+  gcore::Thread::SleepCurrent(100);
+  
+  gBusyAccess.lock();
+  gBusy -= 1;
+  gBusyAccess.unlock();
+}
+
+void RunElastic(gcore::ThreadPool::Scheduling sched) {
+  gcore::ThreadPool pool(sched);
+  gcore::Task task;
+  
+  pool.collectStats(true);
+  pool.elastic(1, 4, 200, 20);
+  pool.start(1);
+  
+  gMaxBusy = 0;
+  
+  gcore::Bind(BlockingTask, task);
+  for (int i=0; i<12; ++i) {
+    pool.runTask(task);
+  }
+  
+  double t0 = gcore::Thread::MonotonicTime();
+  pool.wait();
+  double t1 = gcore::Thread::MonotonicTime();
+  
+  // let the extra workers time out
+  size_t grown = pool.numWorkers();
+  for (int i=0; i<100 && pool.numWorkers() > 1; ++i) {
+    gcore::Thread::SleepCurrent(20);
+  }
+  size_t shrunk = pool.numWorkers();
+  
+  // retired workers aren't idle: their alive time stops growing
+  gcore::Thread::SleepCurrent(500);
+  gcore::ThreadPool::Stats stats = pool.stats();
+  bool alive = (stats.workers.size() == 4);
+  for (size_t i=0; alive && i<stats.workers.size(); ++i) {
+    double t = stats.workers[i].idleTime + stats.workers[i].runningTime;
+    alive = (i == 0 ? t >= 0.9 * stats.elapsed : t <= stats.elapsed - 0.4);
+  }
+  
+  pool.stop();
+  
+  safe_print("Elastic (%s): %lu busy worker(s) at most, %lu -> %lu worker(s), %.2fs (%s)\n",
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue"),
+             gMaxBusy, grown, shrunk, t1 - t0,
+             (gMaxBusy > 1 && shrunk == 1 && alive ? "OK" : "FAILED"));
+}
+
+// elastic with per node queues: grown workers may be on nodes without a queue
+
+void BlockingSumTask(unsigned long i) {
+  RangeSum::Submit(new RangeSum(i * 10000, (i + 1) * 10000));
+  BlockingTask();
+}
+
+void RunElasticPlacement(gcore::ThreadPool::Scheduling sched) {
+  gcore::ThreadPool pool(sched);
+  gcore::Task task;
+  
+  pool.placement(gcore::ThreadPool::PL_NUMA_NODES);
+  pool.elastic(1, 8, 200, 20);
+  pool.start(1);
+  
+  gSum = 0;
+  gMaxBusy = 0;
+  
+  for (unsigned long i=0; i<8; ++i) {
+    gcore::Bind(BlockingSumTask, i, task);
+    pool.runTask(task);
+  }
+  
+  pool.wait();
+  
+  size_t grown = pool.numWorkers();
+  size_t nn = pool.numNodes();
+  
+  pool.stop();
+  
+  unsigned long expected = (79999UL * 80000UL) / 2;
+  
+  safe_print("Elastic placement (%s): %lu queue(s), %lu busy worker(s) at most, %lu worker(s), sum %lu (%s)\n",
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue"),
+             nn, gMaxBusy, grown, gSum,
+             (nn == 1 && gMaxBusy > 1 && gSum == expected ? "OK" : "FAILED"));
+}
+
+// stats: counters of the pool and its workers
+
+void RunStats(gcore::ThreadPool::Scheduling sched) {
+  gcore::ThreadPool pool(sched);
+  gcore::Task task;
+  
+  pool.collectStats(true);
+  pool.start(2);
+  
+  gcore::Bind(TinyTask, task);
+  for (int i=0; i<1000; ++i) {
+    pool.runTask(task);
+  }
+  pool.wait();
+  
+  gcore::ThreadPool::Stats stats = pool.stats();
+  
+  size_t timed = 0;
+  for (size_t i=0; i<gcore::ThreadPool::NumHistogramBuckets; ++i) {
+    timed += stats.total.runningHistogram[i];
+  }
+  
+  double busy = stats.total.runningTime / (stats.elapsed * stats.workers.size());
+  
+  safe_print("Stats (%s): %lu executed, %lu helped, %lu stolen, %lu dequeued (max wait %.3fms), %.1f%% busy (%s)\n",
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue"),
+             stats.total.executed, stats.helped, stats.total.steals, stats.total.dequeued,
+             1000.0 * stats.total.maxQueuedTime, 100.0 * busy,
+             (stats.total.executed + stats.helped == 1000 && timed == stats.total.executed ? "OK" : "FAILED"));
+  
+  gcore::PerfLog plog;
+  pool.logStats(plog);
+  pool.stop();
+  
+  // idle time is the alive time of the workers left once running time is
+  // taken out, logged idle time comes from a later snapshot
+  gcore::PerfLog::BaseEntryMap::const_iterator it = plog.entries().find("ThreadPool.idle");
+  double logged = (it != plog.entries().end() ? it->second.totalTime : -1.0);
+  double idle = stats.total.idleTime;
+  double wall = stats.elapsed * stats.workers.size();
+  
+  safe_print("Stats idle (%s): %.3fms idle (%.3fms logged), %.3fms running, %.3fms wall (%s)\n",
+             (sched == gcore::ThreadPool::SCH_WORK_STEALING ? "work stealing" : "shared queue"),
+             1000.0 * idle, 1000.0 * logged, 1000.0 * stats.total.runningTime, 1000.0 * wall,
+             (logged >= idle && idle + stats.total.runningTime <= wall &&
+              idle + stats.total.runningTime >= 0.5 * wall ? "OK" : "FAILED"));
+  
+  plog.print(std::cout, gcore::PerfLog::ShowTotalTime|gcore::PerfLog::ShowNumCalls|gcore::PerfLog::ShowFlat,
+             gcore::PerfLog::SortIdentifier, gcore::PerfLog::MilliSeconds);
+}
+
+void RunDemo(gcore::ThreadPool::Scheduling sched) {
   
   int i;
   size_t n;
@@ -101,7 +609,7 @@ int main(int, char**) {
   gcore::Bind(&tmp2, &PApp2<char, int>::apply, task[2]);
   gcore::Bind(&tmp3, &PApp2<char, int>::apply, task[3]);
 
-  gcore::ThreadPool pool;
+  gcore::ThreadPool pool(sched);
 
   safe_print("Start thread pool\n");
   pool.start(8);
@@ -152,5 +660,66 @@ int main(int, char**) {
   
   safe_print("Done, executed %d tasks\n", gExecutedCount);
 
+}
+
+int main(int, char**) {
+  
+  RunDemo(gcore::ThreadPool::SCH_SHARED_QUEUE);
+  
+  gExecutedCount = 0;
+  
+  RunDemo(gcore::ThreadPool::SCH_WORK_STEALING);
+  
+  RunForkJoin(gcore::ThreadPool::SCH_SHARED_QUEUE);
+  
+  RunForkJoin(gcore::ThreadPool::SCH_WORK_STEALING);
+  
+  RunTaskGroups(gcore::ThreadPool::SCH_SHARED_QUEUE);
+  
+  RunTaskGroups(gcore::ThreadPool::SCH_WORK_STEALING);
+  
+  RunFutures(gcore::ThreadPool::SCH_SHARED_QUEUE);
+  
+  RunFutures(gcore::ThreadPool::SCH_WORK_STEALING);
+  
+  RunPriorities(gcore::ThreadPool::SCH_SHARED_QUEUE);
+  
+  RunPriorities(gcore::ThreadPool::SCH_WORK_STEALING);
+  
+  RunElastic(gcore::ThreadPool::SCH_SHARED_QUEUE);
+  
+  RunElastic(gcore::ThreadPool::SCH_WORK_STEALING);
+  
+  RunStats(gcore::ThreadPool::SCH_SHARED_QUEUE);
+  
+  RunStats(gcore::ThreadPool::SCH_WORK_STEALING);
+  
+  safe_print("%d NUMA node(s), %d processor(s)\n",
+             gcore::Thread::GetNodeCount(), gcore::Thread::GetProcessorCount());
+  
+  RunPlacement(gcore::ThreadPool::SCH_SHARED_QUEUE, gcore::ThreadPool::PL_COMPACT);
+  
+  RunPlacement(gcore::ThreadPool::SCH_WORK_STEALING, gcore::ThreadPool::PL_SCATTER);
+  
+  RunPlacement(gcore::ThreadPool::SCH_SHARED_QUEUE, gcore::ThreadPool::PL_NUMA_NODES);
+  
+  RunPlacement(gcore::ThreadPool::SCH_WORK_STEALING, gcore::ThreadPool::PL_NUMA_NODES);
+  
+  RunElasticPlacement(gcore::ThreadPool::SCH_SHARED_QUEUE);
+  
+  RunElasticPlacement(gcore::ThreadPool::SCH_WORK_STEALING);
+  
+  safe_print("Throughput (tiny tasks):\n");
+  
+  size_t maxThreads = size_t(gcore::Thread::GetProcessorCount());
+  if (maxThreads < 2) {
+    maxThreads = 2;
+  }
+  
+  for (size_t nt=1; nt<=maxThreads; nt*=2) {
+    Benchmark(gcore::ThreadPool::SCH_SHARED_QUEUE, nt, 200000);
+    Benchmark(gcore::ThreadPool::SCH_WORK_STEALING, nt, 200000);
+  }
+  
   return 0;
 }
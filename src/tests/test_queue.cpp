@@ -0,0 +1,316 @@
+/*
+MIT License
+
+Copyright (c) 2009 Gaetan Guidet
+
+This file is part of gcore.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gcore/all.h>
+#include <gcore/platform.h>
+#include <deque>
+#include <vector>
+
+// Baseline: what ThreadPool and EventQueue currently use
+
+template <typename T>
+class LockedQueue {
+  public:
+    
+    LockedQueue(size_t capacity)
+      : mCapacity(capacity) {
+    }
+    
+    bool push(const T &val) {
+      gcore::ScopeLock lock(mAccess);
+      if (mItems.size() >= mCapacity) {
+        return false;
+      }
+      mItems.push_back(val);
+      return true;
+    }
+    
+    bool pop(T &val) {
+      gcore::ScopeLock lock(mAccess);
+      if (mItems.empty()) {
+        return false;
+      }
+      val = mItems.front();
+      mItems.pop_front();
+      return true;
+    }
+    
+  private:
+    
+    size_t mCapacity;
+    std::deque<T> mItems;
+    gcore::Mutex mAccess;
+};
+
+// Each producer pushes values 1..count, each consumer sums what it pops
+// until it gets an end marker (0)
+
+template <class Queue>
+class Contention {
+  public:
+    
+    Contention(size_t numProducers, size_t numConsumers, size_t count)
+      : mQueue(1024), mNumProducers(numProducers), mNumConsumers(numConsumers), mCount(count),
+        mConsumed(0), mSum(0) {
+    }
+    
+    int produce() {
+      for (size_t i=1; i<=mCount; ++i) {
+        while (!mQueue.push(i)) {
+          gcore::Thread::YieldCurrent();
+        }
+      }
+      return 0;
+    }
+    
+    int consume() {
+      size_t sum = 0;
+      size_t val = 0;
+      size_t n = 0;
+      
+      for (;;) {
+        if (mQueue.pop(val)) {
+          if (val == 0) {
+            // end marker
+            break;
+          }
+          sum += val;
+          ++n;
+        } else {
+          gcore::Thread::YieldCurrent();
+        }
+      }
+      
+      gcore::ScopeLock lock(mAccess);
+      mConsumed += n;
+      mSum += sum;
+      return 0;
+    }
+    
+    double run() {
+      std::vector<gcore::Thread*> consumers;
+      std::vector<gcore::Thread*> producers;
+      
+      double t0 = gcore::Thread::MonotonicTime();
+      
+      for (size_t i=0; i<mNumConsumers; ++i) {
+        consumers.push_back(new gcore::Thread(this, &Contention<Queue>::consume));
+      }
+      for (size_t i=0; i<mNumProducers; ++i) {
+        producers.push_back(new gcore::Thread(this, &Contention<Queue>::produce));
+      }
+      for (size_t i=0; i<producers.size(); ++i) {
+        producers[i]->join();
+        delete producers[i];
+      }
+      // one end marker per consumer
+      for (size_t i=0; i<consumers.size(); ++i) {
+        while (!mQueue.push(0)) {
+          gcore::Thread::YieldCurrent();
+        }
+      }
+      for (size_t i=0; i<consumers.size(); ++i) {
+        consumers[i]->join();
+        delete consumers[i];
+      }
+      
+      double t1 = gcore::Thread::MonotonicTime();
+      
+      return (t1 - t0);
+    }
+    
+    bool check() const {
+      size_t expected = mNumProducers * (mCount * (mCount + 1) / 2);
+      return (mConsumed == mNumProducers * mCount && mSum == expected);
+    }
+    
+  private:
+    
+    Queue mQueue;
+    size_t mNumProducers;
+    size_t mNumConsumers;
+    size_t mCount;
+    size_t mConsumed;
+    size_t mSum;
+    gcore::Mutex mAccess;
+};
+
+template <class Queue>
+bool Benchmark(const char *name, size_t numProducers, size_t numConsumers, size_t count) {
+  Contention<Queue> bench(numProducers, numConsumers, count);
+  double t = bench.run();
+  bool ok = bench.check();
+  fprintf(stdout, "  %s, %lu producer(s) / %lu consumer(s): %12.0f items/sec%s\n",
+          name, (unsigned long)numProducers, (unsigned long)numConsumers,
+          double(numProducers * count) / t, (ok ? "" : " [FAILED]"));
+  return ok;
+}
+
+// SPSC: consumer checks values come in order
+
+class Stream {
+  public:
+    
+    Stream(size_t count)
+      : mCount(count), mOrdered(true) {
+    }
+    
+    int produce() {
+      for (size_t i=1; i<=mCount; ++i) {
+        mQueue.push(i);
+      }
+      return 0;
+    }
+    
+    int consume() {
+      size_t expected = 1;
+      size_t val = 0;
+      while (expected <= mCount) {
+        if (mQueue.pop(val)) {
+          if (val != expected) {
+            mOrdered = false;
+          }
+          ++expected;
+        } else {
+          gcore::Thread::YieldCurrent();
+        }
+      }
+      return 0;
+    }
+    
+    bool run() {
+      double t0 = gcore::Thread::MonotonicTime();
+      gcore::Thread consumer(this, &Stream::consume);
+      gcore::Thread producer(this, &Stream::produce);
+      producer.join();
+      consumer.join();
+      double t1 = gcore::Thread::MonotonicTime();
+      fprintf(stdout, "  spsc queue: %12.0f items/sec%s\n", double(mCount) / (t1 - t0), (mOrdered ? "" : " [FAILED]"));
+      return mOrdered && mQueue.empty();
+    }
+    
+  private:
+    
+    gcore::SPSCQueue<size_t> mQueue;
+    size_t mCount;
+    bool mOrdered;
+};
+
+// Atomic counters: each thread increments a shared counter, the last one
+// to finish sees the total
+
+class Counter {
+  public:
+    
+    Counter(size_t count)
+      : mCount(count), mValue(0), mMaxValue(0), mRunning(0) {
+    }
+    
+    int run() {
+      for (size_t i=0; i<mCount; ++i) {
+        size_t v = mValue.fetchAdd(1, gcore::MO_RELAXED) + 1;
+        // keep track of the maximum with a CAS loop
+        size_t cur = mMaxValue.load(gcore::MO_RELAXED);
+        while (v > cur && !mMaxValue.compareExchange(cur, v, gcore::MO_RELAXED)) {
+        }
+      }
+      --mRunning;
+      return 0;
+    }
+    
+    bool run(size_t numThreads) {
+      std::vector<gcore::Thread*> threads;
+      mRunning = numThreads;
+      for (size_t i=0; i<numThreads; ++i) {
+        threads.push_back(new gcore::Thread(this, &Counter::run));
+      }
+      for (size_t i=0; i<numThreads; ++i) {
+        threads[i]->join();
+        delete threads[i];
+      }
+      size_t expected = numThreads * mCount;
+      fprintf(stdout, "  %lu thread(s): %lu (max %lu, running %lu)\n", (unsigned long)numThreads,
+              (unsigned long)mValue.load(), (unsigned long)mMaxValue.load(), (unsigned long)mRunning.load());
+      return (mValue == expected && mMaxValue == expected && mRunning == 0);
+    }
+    
+  private:
+    
+    size_t mCount;
+    gcore::Atomic<size_t> mValue;
+    gcore::Atomic<size_t> mMaxValue;
+    gcore::Atomic<long> mRunning;
+};
+
+bool TestAtomicPointer() {
+  int values[4] = {0, 1, 2, 3};
+  gcore::Atomic<int*> ptr(values);
+  
+  int *p0 = ptr++;
+  int *p2 = (ptr += 1);
+  int *expected = values;
+  // fails: ptr is values+2, expected gets updated
+  bool swapped = ptr.compareExchange(expected, values + 3);
+  int *p3 = ptr.exchange(values + 3);
+  
+  return (*p0 == 0 && *p2 == 2 && !swapped && expected == values + 2 && p3 == values + 2 && *ptr == 3);
+}
+
+int main(int, char**) {
+  bool ok = true;
+  size_t count = 200000;
+  size_t maxThreads = (size_t) gcore::Thread::GetProcessorCount();
+  
+  if (maxThreads < 2) {
+    maxThreads = 2;
+  }
+  
+  fprintf(stdout, "Atomic counters...\n");
+  
+  for (size_t nt=1; nt<=maxThreads; nt*=2) {
+    Counter counter(100000);
+    ok = counter.run(nt) && ok;
+  }
+  
+  if (!TestAtomicPointer()) {
+    fprintf(stdout, "  pointer operations [FAILED]\n");
+    ok = false;
+  }
+  
+  fprintf(stdout, "Queue contention...\n");
+  
+  for (size_t nt=1; nt<=maxThreads; nt*=2) {
+    ok = Benchmark<LockedQueue<size_t> >("mutex+deque", nt, nt, count) && ok;
+    ok = Benchmark<gcore::MPMCQueue<size_t> >("mpmc queue ", nt, nt, count) && ok;
+  }
+  
+  Stream stream(1000000);
+  ok = stream.run() && ok;
+  
+  fprintf(stdout, "%s\n", (ok ? "OK" : "FAILED"));
+  
+  return (ok ? 0 : 1);
+}
@@ -146,6 +146,83 @@ class State
     mutable gcore::Condition m_t2done;
 };
 
+class Tally
+{
+  public:
+    
+    Tally()
+      :m_ready(0), m_release(false), m_total(0)
+    {
+    }
+    
+    int run()
+    {
+      for (int i=0; i<1000; ++i)
+      {
+        // no lock needed, each thread has its own counter
+        *m_counts += 1;
+      }
+      
+      // stay alive until the counts have been collected
+      m_mtx.lock();
+      m_ready += 1;
+      m_readyCond.notifyAll();
+      while (m_release == false)
+      {
+        m_releaseCond.wait(m_mtx);
+      }
+      m_mtx.unlock();
+      
+      return 0;
+    }
+    
+    bool add(int &count)
+    {
+      m_total += count;
+      return true;
+    }
+    
+    int collect(int numThreads)
+    {
+      m_mtx.lock();
+      while (m_ready < numThreads)
+      {
+        m_readyCond.wait(m_mtx);
+      }
+      m_mtx.unlock();
+      
+      gcore::ThreadLocal<int>::EachFunc func;
+      gcore::Bind(this, &Tally::add, func);
+      m_total = 0;
+      m_counts.each(func);
+      
+      return m_total;
+    }
+    
+    void release()
+    {
+      m_mtx.lock();
+      m_release = true;
+      m_releaseCond.notifyAll();
+      m_mtx.unlock();
+    }
+    
+    size_t alive() const
+    {
+      return m_counts.count();
+    }
+    
+  protected:
+    
+    gcore::ThreadLocal<int> m_counts;
+    int m_ready;
+    bool m_release;
+    int m_total;
+    gcore::Mutex m_mtx;
+    gcore::Condition m_readyCond;
+    gcore::Condition m_releaseCond;
+};
+
 int main(int, char **)
 {
   State s;
@@ -156,6 +233,26 @@ int main(int, char **)
   thr1.join();
   thr1.join();
   
+  Tally t;
+  gcore::Thread *tthr[4];
+  
+  for (int i=0; i<4; ++i)
+  {
+    tthr[i] = new gcore::Thread(&t, &Tally::run);
+  }
+  
+  int total = t.collect(4);
+  s.print(stderr, "\nThread local counts: %d in %lu thread(s)\n", total, (unsigned long)t.alive());
+  
+  t.release();
+  for (int i=0; i<4; ++i)
+  {
+    tthr[i]->join();
+    delete tthr[i];
+  }
+  
+  s.print(stderr, "Thread local values left after threads exit: %lu\n", (unsigned long)t.alive());
+  
   s.print(stderr, "\nThat's all folks !!\n");
 
   return 0;
@@ -0,0 +1,308 @@
+/*
+MIT License
+
+Copyright (c) 2009 Gaetan Guidet
+
+This file is part of gcore.
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <gcore/all.h>
+#include <gcore/platform.h>
+#include <vector>
+
+gcore::Mutex gAccess;
+std::vector<int> gFired;
+int gTicks = 0;
+bool gInWorker = false;
+
+void Fire(int id) {
+  gcore::ScopeLock lock(gAccess);
+  gFired.push_back(id);
+}
+
+void Tick() {
+  gcore::ScopeLock lock(gAccess);
+  ++gTicks;
+}
+
+void FireInWorker(gcore::SyncEvent *ev) {
+  gInWorker = (gcore::ThreadPool::Current() != 0);
+  ev->set();
+}
+
+void TestOrder(gcore::TimerWheel &wheel) {
+  gcore::Functor0 cb;
+  int delays[] = {50, 10, 40, 20, 30};
+  
+  for (int i=0; i<5; ++i) {
+    gcore::Bind(Fire, delays[i], cb);
+    wheel.schedule(cb, delays[i]);
+  }
+  
+  gcore::Bind(Fire, 0, cb);
+  gcore::TimerID id = wheel.schedule(cb, 25);
+  bool cancelled = wheel.cancel(id);
+  bool again = wheel.cancel(id);
+  
+  double t0 = gcore::Thread::MonotonicTime();
+  while (wheel.numPending() > 0) {
+    gcore::Thread::SleepCurrent(5);
+  }
+  double t1 = gcore::Thread::MonotonicTime();
+  
+  bool ordered = (gFired.size() == 5);
+  for (size_t i=0; ordered && i<gFired.size(); ++i) {
+    ordered = (gFired[i] == 10 * int(i + 1));
+  }
+  
+  fprintf(stdout, "One shot timers: %lu fired in %.0fms, cancel %d/%d (%s)\n",
+          gFired.size(), 1000.0 * (t1 - t0), cancelled, again,
+          (ordered && cancelled && !again && t1 - t0 >= 0.045 ? "OK" : "FAILED"));
+}
+
+// timers further than the first wheel level are moved down as time passes
+
+double gStart = 0.0;
+std::vector<double> gFiredAt;
+
+void FireAt() {
+  gcore::ScopeLock lock(gAccess);
+  gFiredAt.push_back(gcore::Thread::MonotonicTime() - gStart);
+}
+
+void TestCascade(gcore::TimerWheel &wheel) {
+  gcore::Functor0 cb;
+  gcore::Bind(FireAt, cb);
+  
+  gStart = gcore::Thread::MonotonicTime();
+  wheel.schedule(cb, 300);
+  wheel.schedule(cb, 700);
+  
+  while (wheel.numPending() > 0) {
+    gcore::Thread::SleepCurrent(5);
+  }
+  
+  bool onTime = (gFiredAt.size() == 2 &&
+                 gFiredAt[0] >= 0.29 && gFiredAt[0] < 0.35 &&
+                 gFiredAt[1] >= 0.69 && gFiredAt[1] < 0.75);
+  
+  fprintf(stdout, "Cascaded timers: fired at %.0fms and %.0fms (%s)\n",
+          (gFiredAt.size() > 0 ? 1000.0 * gFiredAt[0] : 0.0),
+          (gFiredAt.size() > 1 ? 1000.0 * gFiredAt[1] : 0.0),
+          (onTime ? "OK" : "FAILED"));
+}
+
+void TestPeriodic(gcore::TimerWheel &wheel) {
+  gcore::Functor0 cb;
+  gcore::Bind(Tick, cb);
+  
+  gcore::TimerID id = wheel.schedule(cb, 10, 10);
+  gcore::Thread::SleepCurrent(105);
+  bool cancelled = wheel.cancel(id);
+  
+  gAccess.lock();
+  int ticks = gTicks;
+  gAccess.unlock();
+  
+  fprintf(stdout, "Periodic timer: %d ticks in 105ms (%s)\n", ticks,
+          (cancelled && ticks >= 5 && ticks <= 11 ? "OK" : "FAILED"));
+}
+
+void TestDispatch(gcore::TimerWheel &wheel) {
+  gcore::ThreadPool pool;
+  gcore::EventQueue queue;
+  gcore::SyncEvent ev;
+  gcore::Functor0 cb;
+  
+  pool.start(1);
+  
+  gcore::Bind(FireInWorker, &ev, cb);
+  wheel.schedule(cb, pool, 5);
+  bool inPool = (ev.timedWait(1000) && gInWorker);
+  
+  gFired.clear();
+  gcore::Bind(Fire, 1, cb);
+  wheel.schedule(cb, queue, 5);
+  
+  // the callback is only run by the queue owner
+  double t0 = gcore::Thread::MonotonicTime();
+  while (gcore::Thread::MonotonicTime() - t0 < 1.0 && queue.poll(1) == 0) {
+    gcore::Thread::SleepCurrent(1);
+  }
+  bool inQueue = (gFired.size() == 1);
+  
+  pool.stop();
+  
+  fprintf(stdout, "Dispatch: pool %s, event queue %s (%s)\n",
+          (inPool ? "yes" : "no"), (inQueue ? "yes" : "no"),
+          (inPool && inQueue ? "OK" : "FAILED"));
+}
+
+void StopWheel(gcore::TimerWheel *wheel) {
+  Fire(wheel->stop() ? 1 : 0);
+}
+
+void TestStopFromCallback() {
+  gcore::Functor0 cb;
+  gcore::TimerWheel wheel;
+  
+  wheel.start();
+  
+  gFired.clear();
+  gcore::Bind(StopWheel, &wheel, cb);
+  wheel.schedule(cb, 10);
+  
+  double t0 = gcore::Thread::MonotonicTime();
+  while (gcore::Thread::MonotonicTime() - t0 < 1.0 && wheel.running()) {
+    gcore::Thread::SleepCurrent(5);
+  }
+  bool stopped = (!wheel.running() && gFired.size() == 1 && gFired[0] == 1);
+  
+  // restarts once the thread exited, after an idle period
+  t0 = gcore::Thread::MonotonicTime();
+  while (gcore::Thread::MonotonicTime() - t0 < 1.0 && !wheel.start()) {
+    gcore::Thread::SleepCurrent(5);
+  }
+  gcore::Thread::SleepCurrent(200);
+  
+  gFired.clear();
+  gcore::Bind(Fire, 2, cb);
+  t0 = gcore::Thread::MonotonicTime();
+  wheel.schedule(cb, 20);
+  while (gcore::Thread::MonotonicTime() - t0 < 1.0 && wheel.numPending() > 0) {
+    gcore::Thread::SleepCurrent(1);
+  }
+  double elapsed = gcore::Thread::MonotonicTime() - t0;
+  bool restarted = (gFired.size() == 1 && elapsed >= 0.02 && elapsed < 0.5);
+  
+  fprintf(stdout, "Stop from callback: %s, restarted: %s, fired after %.0f ms (%s)\n",
+          (stopped ? "yes" : "no"), (restarted ? "yes" : "no"), 1000.0 * elapsed,
+          (stopped && restarted ? "OK" : "FAILED"));
+  
+  // the destructor stops the wheel again
+}
+
+struct Delayed {
+  double scheduled;
+  double fired;
+};
+
+void FireDelayed(Delayed *d) {
+  gcore::ScopeLock lock(gAccess);
+  d->fired = gcore::Thread::MonotonicTime();
+}
+
+void TestMinimumDelay() {
+  gcore::Functor0 cb;
+  gcore::TimerWheel wheel;
+  unsigned long delays[] = {1, 5, 10, 15, 20, 25};
+  Delayed timers[6];
+  
+  // coarse resolution: timers scheduled part way through a tick
+  wheel.start(10);
+  
+  for (int i=0; i<6; ++i) {
+    gcore::Thread::SleepCurrent(3);
+    gcore::Bind(FireDelayed, &timers[i], cb);
+    timers[i].fired = 0.0;
+    timers[i].scheduled = gcore::Thread::MonotonicTime();
+    wheel.schedule(cb, delays[i]);
+  }
+  
+  double t0 = gcore::Thread::MonotonicTime();
+  while (gcore::Thread::MonotonicTime() - t0 < 1.0 && wheel.numPending() > 0) {
+    gcore::Thread::SleepCurrent(1);
+  }
+  wheel.stop();
+  
+  bool ok = true;
+  double early = 0.0;
+  
+  gAccess.lock();
+  for (int i=0; i<6; ++i) {
+    double elapsed = timers[i].fired - timers[i].scheduled;
+    double margin = elapsed - 0.001 * double(delays[i]);
+    if (timers[i].fired <= 0.0 || margin < 0.0) {
+      ok = false;
+    }
+    if (i == 0 || margin < early) {
+      early = margin;
+    }
+  }
+  gAccess.unlock();
+  
+  fprintf(stdout, "Minimum delay (10 ms resolution): closest fire %.1f ms after the delay (%s)\n",
+          1000.0 * early, (ok ? "OK" : "FAILED"));
+}
+
+void Nothing() {
+}
+
+void Benchmark(gcore::TimerWheel &wheel, size_t count) {
+  std::vector<gcore::TimerID> ids(count);
+  gcore::Functor0 cb;
+  gcore::Bind(Nothing, cb);
+  
+  // pending timers spread over 10 minutes
+  double t0 = gcore::Thread::MonotonicTime();
+  for (size_t i=0; i<count; ++i) {
+    ids[i] = wheel.schedule(cb, 1000 + (unsigned long)((i * 7919) % 600000));
+  }
+  double t1 = gcore::Thread::MonotonicTime();
+  size_t pending = wheel.numPending();
+  
+  size_t cancelled = 0;
+  for (size_t i=0; i<count; ++i) {
+    cancelled += (wheel.cancel(ids[i]) ? 1 : 0);
+  }
+  double t2 = gcore::Thread::MonotonicTime();
+  
+  fprintf(stdout, "%lu timers: schedule %.0f/sec, cancel %.0f/sec (%s)\n", count,
+          double(count) / (t1 - t0), double(count) / (t2 - t1),
+          (pending == count && cancelled == count && wheel.numPending() == 0 ? "OK" : "FAILED"));
+}
+
+int main(int, char**) {
+  
+  gcore::TimerWheel wheel;
+  
+  wheel.start();
+  
+  TestOrder(wheel);
+  
+  TestCascade(wheel);
+  
+  TestPeriodic(wheel);
+  
+  TestDispatch(wheel);
+  
+  TestStopFromCallback();
+  
+  TestMinimumDelay();
+  
+  Benchmark(wheel, 10000);
+  
+  Benchmark(wheel, 300000);
+  
+  wheel.stop();
+  
+  return 0;
+}